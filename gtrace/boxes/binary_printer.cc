@@ -0,0 +1,84 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/binary_printer.cc, this file is part of gtrace.
+
+#include <gtrace/boxes/binary_printer.hh>
+#include <gtrace/tools/binary_io.hh>
+#include <gtrace/tools/layered_arghs.hh>
+
+#include <cstdint>
+#include <stdexcept>
+
+binary_printer::binary_printer(const settings_t& settings, std::ostream& os)
+    : observer_box_t(os), is_float32_(settings.float32), skip_(settings.skip),
+      frame_rows_(std::max<size_t>(settings.frame_rows, 1)),
+      skipped_steps_(settings.skip_initial ? 0 : settings.skip) {}
+
+void binary_printer::append_value(double x) const {
+  if (is_float32_) {
+    float value = x;
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    frame_.insert(frame_.end(), bytes, bytes + sizeof(value));
+  } else {
+    const char* bytes = reinterpret_cast<const char*>(&x);
+    frame_.insert(frame_.end(), bytes, bytes + sizeof(x));
+  }
+}
+
+void binary_printer::flush() const {
+  if (n_rows_ == 0) return;
+  ostream_.write(magic_, sizeof(magic_) - 1);
+  write_binary(ostream_, (uint64_t)n_columns_);
+  write_binary(ostream_, (uint64_t)n_rows_);
+  write_binary(ostream_, (uint64_t)(is_float32_ ? 4 : 8));
+  ostream_.write(frame_.data(), frame_.size());
+  frame_.clear();
+  n_rows_ = 0;
+}
+
+bool binary_printer::operator()(
+    const pusher_box_t* pusher, double time) const {
+  if (skipped_steps_ < skip_) skipped_steps_++;
+  else {
+    std::list<double> values = pusher->compose_output_values(time);
+    if (n_rows_ == 0) n_columns_ = values.size();
+    else if (values.size() != n_columns_)
+      throw std::runtime_error("binary_printer: varying number of columns.");
+    for (double x : values) this->append_value(x);
+    if (++n_rows_ == frame_rows_) this->flush();
+    skipped_steps_ = 0;
+  }
+  return true;
+}
+
+binary_printer::settings_t binary_printer::parse_settings(
+    const argh::parser& arghs) {
+  return parse_settings(
+      arghs,
+      {.float32 = false, .frame_rows = 4096, .skip = 0, .skip_initial = false});
+}
+
+binary_printer::settings_t binary_printer::parse_settings(
+    const argh::parser& arghs, const settings_t& base) {
+  settings_t settings = base;
+  settings.float32 = layered_flag(arghs, "float32", base.float32);
+  arghs("frame-rows", base.frame_rows) >> settings.frame_rows;
+  arghs("skip", base.skip) >> settings.skip;
+  settings.skip_initial =
+      layered_flag(arghs, "skip-initial", base.skip_initial);
+  return settings;
+}
@@ -0,0 +1,83 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/binary_printer.hh, this file is part of gtrace.
+
+#ifndef GTRACE_BINARY_PRINTER
+#define GTRACE_BINARY_PRINTER
+
+#include <gtrace/boxes/observer_box.hh>
+
+#include <vector>
+
+/*!
+Sequential integration-step printer, in binary.
+-----------------------------------------------
+
+Writes the same values as `step_printer` (ie, those listed by the pusher's
+`compose_output_fields()`), eventually skipping time steps, but as typed binary
+arrays instead of text, sparing both the formatting time and most of the output
+size of dense trajectories. Rows are buffered and written in frames of up to
+`-frame-rows` rows, each frame made of the 8-byte magic string `GTRACEBF`, the
+numbers of columns, rows, and bytes per value (three `uint64_t`), and then the
+row-major values (`double` or, with `-float32`, `float`), all in the native byte
+order. The last frame is written by `flush()`, called by drivers once the orbit
+ends. Each gyron's frames follow the text lines (starting with `#`) written by
+the drivers in its output block, ie, the `# fields:` line naming the columns and
+eventually the gyron's id, while the run header at the top of the output records
+the run arguments (see `driver_box_t::header_string()`); the output is thus
+self-describing and is read, eg, from python by
+
+    f = open(name, "rb")
+    while c := f.peek(1)[:1]:
+      if c == b"#": print(f.readline().decode(), end="")
+      else:
+        nc, nr, nb = numpy.frombuffer(f.read(32)[8:], numpy.uint64)
+        rows = numpy.frombuffer(f.read(int(nc*nr*nb)), f"f{nb}").reshape(nr, nc)
+
+Observer options:
+
+ + `-float32` Writes single-precision values (default double precision).
+ + `-frame-rows=val` Maximum number of rows per frame (default 4096).
+ + `-skip=val` Number of time steps to be skipped (default 0).
+ + `-skip-initial` Skips also the step corresponding to time=0.
+!*/
+class binary_printer : public observer_box_t {
+ public:
+  struct settings_t {
+    bool float32;
+    size_t frame_rows, skip;
+    bool skip_initial;
+  };
+  static settings_t parse_settings(const argh::parser& arghs);
+  static settings_t parse_settings(
+      const argh::parser& arghs, const settings_t& base_settings);
+  binary_printer() = delete;
+  binary_printer(const settings_t& settings, std::ostream& os);
+  virtual ~binary_printer() {};
+  virtual bool operator()(
+      const pusher_box_t* pusher, double time) const override;
+  virtual void flush() const override;
+ private:
+  static constexpr char magic_[] = "GTRACEBF";
+  const bool is_float32_;
+  const size_t skip_, frame_rows_;
+  mutable size_t skipped_steps_, n_columns_ = 0, n_rows_ = 0;
+  mutable std::vector<char> frame_;
+  void append_value(double x) const;
+};
+
+#endif  // GTRACE_BINARY_PRINTER
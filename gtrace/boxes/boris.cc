@@ -20,8 +20,12 @@
 #include <gyronimo/core/codata.hh>
 
 #include <gtrace/boxes/boris.hh>
+#include <gtrace/tools/binary_io.hh>
+#include <gtrace/tools/layered_arghs.hh>
 
 #include <algorithm>
+#include <cmath>
+#include <sstream>
 
 boris::boris(const settings_t& s, const field_box_t* field_box)
     : pusher_box_t(field_box), settings_(s),
@@ -34,6 +38,29 @@ boris::boris(const settings_t& s, const field_box_t* field_box)
   state_ = stepper_.half_back_step(q_initial, v_initial, 0.0, time_step_);
 }
 
+std::string boris::compose_invariant_fields() const {
+  std::string fields = (this->is_energy_invariant() ? "energy mu" : "mu");
+  if (field_box_->is_axisymmetric()) fields += " Pphi";
+  return fields;
+}
+
+std::list<double> boris::compose_invariant_values(double time) const {
+  std::list<double> values;
+  if (this->is_energy_invariant())
+    values.push_back(this->get_total_energy(time, settings_.charge));
+  IR3 q = stepper_.get_position(state_);
+  values.push_back(
+      stepper_.energy_perpendicular(state_, time) /
+      field_box_->get_magnetic_field()->magnitude(q, time));
+  if (field_box_->is_axisymmetric()) {
+    IR3 dot_q = (settings_.vref / settings_.lref) * stepper_.get_dot_q(state_);
+    double v_w = field_box_->get_metric()->to_covariant(dot_q, q)[IR3::w];
+    values.push_back(this->get_toroidal_momentum(
+        time, v_w, settings_.charge / settings_.mass));
+  }
+  return values;
+}
+
 std::string boris::compose_output_fields() const {
   std::string output_fields("# fields: t qu qv qw vx vy vz");
   if (settings_.pxyz) output_fields += " x y z";
@@ -62,8 +89,35 @@ std::list<double> boris::compose_output_values(double time) const {
   return output_values;
 }
 
+std::string boris::compose_state_signature() const {
+  std::ostringstream signature;
+  signature.precision(17);
+  signature << "boris dt=" << time_step_ << " charge=" << settings_.charge
+            << " lref=" << settings_.lref << " mass=" << settings_.mass
+            << " vref=" << settings_.vref;
+  return signature.str();
+}
+
 IR3 boris::get_dot_q(double time) const { return stepper_.get_dot_q(state_); }
 
+double boris::get_energy(double time) const {
+  using gyronimo::codata::e, gyronimo::codata::m_proton;
+  const double energy_ref_ev =
+      0.5 * m_proton * settings_.mass * settings_.vref * settings_.vref / e;
+  return energy_ref_ev * (stepper_.energy_parallel(state_, time) +
+                          stepper_.energy_perpendicular(state_, time));
+}
+
+double boris::get_pitch(double time) const {
+  double energy_parallel = stepper_.energy_parallel(state_, time);
+  double energy =
+      energy_parallel + stepper_.energy_perpendicular(state_, time);
+  double pitch = (energy > 0 ? std::sqrt(energy_parallel / energy) : 0);
+  IR3 q = stepper_.get_position(state_);
+  IR3 b = field_box_->get_magnetic_field()->covariant(q, time);
+  return (inner_product(stepper_.get_dot_q(state_), b) < 0 ? -pitch : pitch);
+}
+
 IR3 boris::get_q(double time) const { return stepper_.get_position(state_); }
 
 IR3 boris::initial_velocity_from_energy_data() const {
@@ -80,24 +134,37 @@ IR3 boris::initial_velocity_from_energy_data() const {
       settings_.gyrophase, q_initial, 0);  // time=0 ok, this is initialisation!
 }
 
+void boris::load_state(std::istream& is) { read_binary(is, state_); }
+
 boris::settings_t boris::parse_settings(const argh::parser& arghs) {
-  settings_t settings;
-  arghs("samples", 512) >> settings.samples;
-  arghs("tfinal", 1) >> settings.time_final;
-  arghs("lref", 1) >> settings.lref;
-  arghs("vref", 1) >> settings.vref;
-  arghs("mass", 1) >> settings.mass;
-  arghs("charge", 1) >> settings.charge;
-  arghs("qu", 0.1) >> settings.qu;
-  arghs("qv", 0) >> settings.qv;
-  arghs("qw", 0) >> settings.qw;
-  arghs("energy", 1) >> settings.energy;
-  arghs("pitch", 0.5) >> settings.pitch;
-  arghs("gyrophase", 0) >> settings.gyrophase;
-  settings.pb = arghs["pb"];
-  settings.pjac = arghs["pjac"];
-  settings.pkin = arghs["pkin"];
-  settings.pxyz = arghs["pxyz"];
+  settings_t defaults = {
+      .samples = 512, .charge = 1, .lref = 1, .mass = 1, .time_final = 1,
+      .vref = 1, .qu = 0.1, .qv = 0, .qw = 0, .energy = 1, .gyrophase = 0,
+      .pitch = 0.5, .weight = 1, .pb = false, .pjac = false, .pkin = false,
+      .pxyz = false};
+  return parse_settings(arghs, defaults);
+}
+
+boris::settings_t boris::parse_settings(
+    const argh::parser& arghs, const settings_t& base) {
+  settings_t settings = base;
+  arghs("samples", base.samples) >> settings.samples;
+  arghs("tfinal", base.time_final) >> settings.time_final;
+  arghs("lref", base.lref) >> settings.lref;
+  arghs("vref", base.vref) >> settings.vref;
+  arghs("mass", base.mass) >> settings.mass;
+  arghs("charge", base.charge) >> settings.charge;
+  arghs("qu", base.qu) >> settings.qu;
+  arghs("qv", base.qv) >> settings.qv;
+  arghs("qw", base.qw) >> settings.qw;
+  arghs("energy", base.energy) >> settings.energy;
+  arghs("pitch", base.pitch) >> settings.pitch;
+  arghs("gyrophase", base.gyrophase) >> settings.gyrophase;
+  arghs("weight", base.weight) >> settings.weight;
+  settings.pb = layered_flag(arghs, "pb", base.pb);
+  settings.pjac = layered_flag(arghs, "pjac", base.pjac);
+  settings.pkin = layered_flag(arghs, "pkin", base.pkin);
+  settings.pxyz = layered_flag(arghs, "pxyz", base.pxyz);
   return settings;
 }
 
@@ -105,3 +172,5 @@ double boris::push_state(double time) {
   state_ = stepper_.do_step(state_, time, time_step_);
   return time + time_step_;
 }
+
+void boris::save_state(std::ostream& os) const { write_binary(os, state_); }
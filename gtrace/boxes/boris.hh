@@ -36,7 +36,9 @@ the pusher and the field objects are built from the options supplied in the
 argument list. By default, the overriden virtual method
 `boris::print_state(time)` sends to the output stream the time and the contents
 of `boris::state_t` (no newline). This can be tailored by additional output
-flags.
+flags. Besides the total energy and the toroidal canonical momentum (see
+`pusher_box_t`), the invariants include the magnetic moment `mu` (ie,
+$E_\perp/B$ in normalised units), only an adiabatic invariant of full orbits.
 
 Pusher options:
 
@@ -55,6 +57,7 @@ Pusher options:
     $v_\parallel/v$).
 
  + `-samples=val` Number of time samples (`tfinal/time_step`, default 512).
+ + `-weight=val` Statistical weight of the gyron (default 1).
 
 Options controlling the output:
 
@@ -69,10 +72,12 @@ class boris : public pusher_box_t {
   struct settings_t {
     size_t samples;
     double charge, lref, mass, time_final, vref;
-    double qu, qv, qw, energy, gyrophase, pitch;
+    double qu, qv, qw, energy, gyrophase, pitch, weight;
     bool pb, pjac, pkin, pxyz;
   };
   static settings_t parse_settings(const argh::parser& arghs);
+  static settings_t parse_settings(
+      const argh::parser& arghs, const settings_t& base_settings);
   boris(const settings_t& settings, const field_box_t* field_box);
   virtual ~boris() {};
   virtual double push_state(double time) override;
@@ -80,6 +85,15 @@ class boris : public pusher_box_t {
   virtual IR3 get_q(double time) const override;
   virtual std::string compose_output_fields() const override;
   virtual std::list<double> compose_output_values(double time) const override;
+  virtual std::string compose_invariant_fields() const override;
+  virtual std::list<double> compose_invariant_values(
+      double time) const override;
+  virtual double get_energy(double time) const override;
+  virtual double get_pitch(double time) const override;
+  virtual double get_weight() const override { return settings_.weight; };
+  virtual void save_state(std::ostream& os) const override;
+  virtual void load_state(std::istream& is) override;
+  virtual std::string compose_state_signature() const override;
  private:
   const double time_step_;
   const settings_t settings_;
@@ -0,0 +1,179 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/composite_observer.cc, this file is part of gtrace.
+
+#include <gtrace/boxes/binary_printer.hh>
+#include <gtrace/boxes/composite_observer.hh>
+#include <gtrace/boxes/domain_predicate.hh>
+#include <gtrace/boxes/drift_monitor.hh>
+#include <gtrace/boxes/orbit_summary.hh>
+#include <gtrace/boxes/phase_deposition.hh>
+#include <gtrace/boxes/q_predicate.hh>
+#include <gtrace/boxes/step_printer.hh>
+#include <gtrace/boxes/wall_impact.hh>
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+composite_builder::composite_builder(const argh::parser& shared_arghs)
+    : shared_settings_(composite_observer::parse_settings(shared_arghs)) {
+  for (const std::string& name : shared_settings_.names)
+    builders_.push_back(composite_observer::create_builder(name, shared_arghs));
+}
+
+std::unique_ptr<observer_box_t> composite_builder::operator()(
+    const argh::parser& private_arghs, std::ostream& os) const {
+  composite_observer::settings_t settings =
+      composite_observer::parse_settings(private_arghs, shared_settings_);
+  return std::make_unique<composite_observer>(
+      settings, builders_, private_arghs, os);
+}
+
+composite_observer::composite_observer(
+    const settings_t& settings, const builders_t& builders,
+    const argh::parser& private_arghs, std::ostream& os)
+    : observer_box_t(os), is_discarding_(os.rdbuf() == nullptr),
+      is_appending_(settings.is_appending), gyron_id_(settings.gyron_id) {
+  for (size_t i = 0; i < builders.size(); i++) {
+    member_t member = {.filename = settings.filenames[i]};
+    if (!member.filename.empty()) {
+      member.buffer = std::make_unique<std::ostringstream>();
+      member.buffer->copyfmt(os);
+    }
+    member.observer = (*builders[i])(
+        private_arghs, (member.buffer ? *member.buffer : ostream_));
+    members_.push_back(std::move(member));
+  }
+}
+
+composite_observer::~composite_observer() {
+  try {
+    for (const member_t& member : members_) this->write_buffer(member);
+  } catch (...) {
+  }
+}
+
+void composite_observer::append_to_file(
+    const std::string& filename, const std::string& block,
+    bool is_appending) {
+  static std::mutex mutex;
+  static std::map<std::string, std::ofstream> files;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto [it, is_new] = files.try_emplace(filename);
+  if (is_new)
+    it->second.open(
+        filename,
+        std::ios::binary | (is_appending ? std::ios::app : std::ios::trunc));
+  it->second.write(block.data(), block.size());
+  if (!it->second.flush())
+    throw std::runtime_error("cannot write to file " + filename);
+}
+
+std::unique_ptr<observer_builder_t> composite_observer::create_builder(
+    const std::string& name, const argh::parser& shared_arghs) {
+  if (name == "binary_printer")
+    return std::make_unique<layered_observer_builder<binary_printer>>(
+        shared_arghs);
+  if (name == "domain_predicate")
+    return std::make_unique<layered_observer_builder<domain_predicate>>(
+        shared_arghs);
+  if (name == "drift_monitor")
+    return std::make_unique<layered_observer_builder<drift_monitor>>(
+        shared_arghs);
+  if (name == "orbit_summary")
+    return std::make_unique<layered_observer_builder<orbit_summary>>(
+        shared_arghs);
+  if (name == "phase_deposition")
+    return std::make_unique<layered_observer_builder<phase_deposition>>(
+        shared_arghs);
+  if (name == "q_predicate")
+    return std::make_unique<layered_observer_builder<q_predicate>>(
+        shared_arghs);
+  if (name == "step_printer")
+    return std::make_unique<layered_observer_builder<step_printer>>(
+        shared_arghs);
+  if (name == "wall_impact")
+    return std::make_unique<layered_observer_builder<wall_impact>>(
+        shared_arghs);
+  throw std::invalid_argument("composite_observer: unknown observer " + name);
+}
+
+void composite_observer::flush() const {
+  for (const member_t& member : members_) {
+    member.observer->flush();
+    this->write_buffer(member);
+  }
+}
+
+bool composite_observer::operator()(
+    const pusher_box_t* pusher, double time) const {
+  bool is_going = true;
+  for (const member_t& member : members_)
+    is_going = (*member.observer)(pusher, time) && is_going;
+  return is_going;
+}
+
+composite_observer::settings_t composite_observer::parse_settings(
+    const argh::parser& arghs) {
+  settings_t settings = {
+      .names = {}, .filenames = {}, .gyron_id = "",
+      .is_appending = (arghs["journal"] || arghs("journal"))};
+  std::string list, rank;
+  if (!(arghs("composite") >> list))
+    throw std::invalid_argument("composite_observer: missing -composite.");
+  arghs("mpi-rank", "0") >> rank;
+  std::istringstream list_stream(list);
+  for (std::string item; std::getline(list_stream, item, ',');) {
+    size_t colon = item.find(':');
+    std::string filename =
+        (colon != std::string::npos ? item.substr(colon + 1) : "");
+    if (size_t i = filename.find("%r"); i != std::string::npos)
+      filename.replace(i, 2, rank);
+    settings.names.push_back(item.substr(0, colon));
+    settings.filenames.push_back(filename);
+  }
+  if (settings.names.empty())
+    throw std::invalid_argument("composite_observer: empty -composite.");
+  return parse_settings(arghs, settings);
+}
+
+composite_observer::settings_t composite_observer::parse_settings(
+    const argh::parser& arghs, const settings_t& base) {
+  settings_t settings = base;
+  arghs("gyron-id", base.gyron_id) >> settings.gyron_id;
+  return settings;
+}
+
+void composite_observer::register_reductions(const argh::parser& arghs) {
+  std::string list;
+  arghs("composite", "") >> list;
+  std::istringstream list_stream(list);
+  for (std::string item; std::getline(list_stream, item, ',');)
+    if (item.substr(0, item.find(':')) == "phase_deposition")
+      phase_deposition::local_grid(phase_deposition::parse_settings(arghs));
+}
+
+void composite_observer::write_buffer(const member_t& member) const {
+  if (!member.buffer) return;
+  std::string block = member.buffer->str();
+  member.buffer->str("");
+  if (is_discarding_ || block.empty()) return;
+  if (!gyron_id_.empty()) block = "# gyron id: " + gyron_id_ + "\n" + block;
+  append_to_file(member.filename, block, is_appending_);
+}
@@ -0,0 +1,116 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/composite_observer.hh, this file is part of gtrace.
+
+#ifndef GTRACE_COMPOSITE_OBSERVER
+#define GTRACE_COMPOSITE_OBSERVER
+
+#include <gtrace/boxes/observer_box.hh>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*!
+Chains several observers along the same orbits.
+-----------------------------------------------
+
+Builds the observers listed in `-composite` (eg,
+`-composite=wall_impact:losses.txt,orbit_summary:summary.txt,q_predicate`),
+each with the same options (so that options of different observers sharing a
+name take the same value), and calls them all at each step, in the order of the
+list. The integration stops at the first step where any of them returns false,
+after all of them have been called on that step (so that every observer sees
+the final state). Each item is the name of an observer box, optionally followed
+by the file holding its output: observers without a file write to the driver's
+stream, in the usual blocks, while those with a file write to their own buffer,
+sent to the file as a single block when the orbit ends (ie, on `flush()`) and
+in the format set on the driver's stream when the observer is built (eg,
+`-sci-16`). Files are opened once per process and shared by all threads, with
+blocks in the order the orbits end, each headed by the line `# gyron id: id` if
+the driver sets `-gyron-id`, and discarded whenever the driver discards the
+output (eg, in cost probes); with several processes, a `%r` in the file name is
+replaced with the process rank set by the MPI drivers (`0` otherwise), so that
+each process writes its own file. With `-journal`, files are appended to rather
+than truncated, keeping the blocks of a resumed run; those of gyrons interrupted
+before (never journaled) appear twice, and readers should keep the last block
+of each id. Observers reducing over the ensemble (eg, `phase_deposition`) still
+write their results to the driver's stream at the end of the run.
+
+Ensembles are built by `composite_builder`, which parses the shared options of
+each listed observer only once (see `observer_builder_t`); the list itself is
+a shared option, private values of `-composite` being ignored. Since factories
+link a single observer box, the observers that may be listed are those named
+below, hard-coded in `create_builder()`: a new observer box is made available
+here by adding it to that function and to this list.
+
+Observer options:
+
+ + `-composite=list` Comma-separated list of `observer[:file]` items, among
+    binary_printer, domain_predicate, drift_monitor, orbit_summary,
+    phase_deposition, q_predicate, step_printer, and wall_impact.
+!*/
+class composite_observer : public observer_box_t {
+ public:
+  struct settings_t {
+    std::vector<std::string> names, filenames;
+    std::string gyron_id;
+    bool is_appending;
+  };
+  using builders_t = std::vector<std::unique_ptr<observer_builder_t>>;
+  static settings_t parse_settings(const argh::parser& arghs);
+  static settings_t parse_settings(
+      const argh::parser& arghs, const settings_t& base_settings);
+  static std::unique_ptr<observer_builder_t> create_builder(
+      const std::string& name, const argh::parser& shared_arghs);
+  composite_observer() = delete;
+  composite_observer(
+      const settings_t& settings, const builders_t& builders,
+      const argh::parser& private_arghs, std::ostream& os);
+  virtual ~composite_observer();
+  virtual bool operator()(
+      const pusher_box_t* pusher, double time) const override;
+  virtual void flush() const override;
+  static void register_reductions(const argh::parser& arghs);
+ private:
+  struct member_t {
+    std::string filename;
+    std::unique_ptr<std::ostringstream> buffer;
+    std::unique_ptr<observer_box_t> observer;
+  };
+  const bool is_discarding_, is_appending_;
+  const std::string gyron_id_;
+  std::vector<member_t> members_;
+  void write_buffer(const member_t& member) const;
+  static void append_to_file(
+      const std::string& filename, const std::string& block,
+      bool is_appending);
+};
+
+class composite_builder : public observer_builder_t {
+ public:
+  composite_builder(const argh::parser& shared_arghs);
+  virtual ~composite_builder() {};
+  virtual std::unique_ptr<observer_box_t> operator()(
+      const argh::parser& private_arghs, std::ostream& os) const override;
+ private:
+  const composite_observer::settings_t shared_settings_;
+  composite_observer::builders_t builders_;
+};
+
+#endif  // GTRACE_COMPOSITE_OBSERVER
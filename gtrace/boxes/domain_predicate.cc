@@ -0,0 +1,152 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/domain_predicate.cc, this file is part of gtrace.
+
+#include <gyronimo/metrics/metric_connected.hh>
+#include <gyronimo/metrics/morphism.hh>
+
+#include <gtrace/boxes/domain_predicate.hh>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <numbers>
+#include <sstream>
+
+std::string domain_predicate::compose_box_key() const {
+  std::ostringstream key;
+  key.precision(17);
+  key << period_w_ << " box " << box_->x_min << " " << box_->x_max << " "
+      << box_->y_min << " " << box_->y_max << " " << box_->z_min << " "
+      << box_->z_max << " " << qu_max_ << " " << scan_intervals_ << " " << nv_
+      << " " << nw_;
+  return key.str();
+}
+
+domain_predicate::domain_predicate(
+    const settings_t& settings, std::ostream& os)
+    : q_predicate(settings.predicate, os), box_(settings.box),
+      nv_(settings.nv), nw_(settings.nw),
+      scan_intervals_(std::max<size_t>(settings.scan_intervals, 1)),
+      period_w_(settings.period_w), qu_max_(settings.qu_max),
+      table_(settings.table) {}
+
+bool domain_predicate::is_within_bounds(const IR3& q) const {
+  return q_predicate::is_within_bounds(q) &&
+         q[IR3::u] <= (*table_)(q[IR3::v], q[IR3::w]);
+}
+
+bool domain_predicate::operator()(
+    const pusher_box_t* pusher, double time) const {
+  if (!table_)
+    table_ = shared_table(this->compose_box_key(), [&]() {
+      return this->sample_box(pusher->field_box());
+    });
+  return q_predicate::operator()(pusher, time);
+}
+
+domain_predicate::settings_t domain_predicate::parse_settings(
+    const argh::parser& arghs) {
+  settings_t defaults = {
+      .predicate = q_predicate::parse_settings(arghs), .box = std::nullopt,
+      .table_filename = "", .table = nullptr, .nv = 64, .nw = 64,
+      .scan_intervals = 64, .period_w = 2 * std::numbers::pi, .qu_max = 1};
+  settings_t settings = parse_settings(arghs, defaults);
+  if (!settings.box && !settings.table)
+    throw std::invalid_argument(
+        "domain_predicate: missing -domain-table or -domain-box.");
+  return settings;
+}
+
+domain_predicate::settings_t domain_predicate::parse_settings(
+    const argh::parser& arghs, const settings_t& base) {
+  settings_t settings = base;
+  settings.predicate = q_predicate::parse_settings(arghs, base.predicate);
+  std::string box_list, grid;
+  arghs("domain-period", base.period_w) >> settings.period_w;
+  arghs("domain-qu", base.qu_max) >> settings.qu_max;
+  arghs("domain-scan", base.scan_intervals) >> settings.scan_intervals;
+  if (arghs("domain-grid") >> grid) {
+    std::replace(grid.begin(), grid.end(), ':', ' ');
+    if (!(std::istringstream(grid) >> settings.nv >> settings.nw))
+      throw std::invalid_argument("domain_predicate: invalid -domain-grid.");
+  }
+  if (arghs("domain-table") >> settings.table_filename) settings.box.reset();
+  else if (arghs("domain-box") >> box_list) {
+    box_t box;
+    std::replace(box_list.begin(), box_list.end(), ':', ' ');
+    if (!(std::istringstream(box_list) >> box.x_min >> box.x_max >>
+          box.y_min >> box.y_max >> box.z_min >> box.z_max))
+      throw std::invalid_argument("domain_predicate: invalid -domain-box.");
+    settings.box = box;
+    settings.table_filename.clear();
+  }
+  if (settings.box) settings.table = nullptr;
+  else if (
+      !settings.table_filename.empty() &&
+      (!base.table || settings.table_filename != base.table_filename ||
+       settings.period_w != base.period_w)) {
+    std::ostringstream key;
+    key.precision(17);
+    key << settings.period_w << " table " << settings.table_filename;
+    settings.table = shared_table(key.str(), [&]() {
+      return boundary_table::read(
+          settings.table_filename, 2 * std::numbers::pi, settings.period_w);
+    });
+  }
+  return settings;
+}
+
+boundary_table domain_predicate::sample_box(const field_box_t* field) const {
+  using gyronimo::metric_connected, gyronimo::morphism;
+  auto g = dynamic_cast<const metric_connected*>(field->get_metric());
+  if (!g)
+    throw std::runtime_error(
+        "domain_predicate: -domain-box needs a connected metric.");
+  const morphism& morph(*g->my_morphism());
+  auto is_inside = [&](double u, double v, double w) {
+    IR3 x = morph({u, v, w});
+    return x[0] >= box_->x_min && x[0] <= box_->x_max &&
+           x[1] >= box_->y_min && x[1] <= box_->y_max &&
+           x[2] >= box_->z_min && x[2] <= box_->z_max;
+  };
+  auto s_b = [&](double v, double w) {
+    double du = qu_max_ / scan_intervals_;
+    for (size_t k = 0; k <= scan_intervals_; k++) {
+      if (is_inside(k * du, v, w)) continue;
+      if (k == 0) return 0.0;
+      double inside = (k - 1) * du, outside = k * du;
+      for (size_t n = 0; n < 48; n++) {
+        double middle = 0.5 * (inside + outside);
+        (is_inside(middle, v, w) ? inside : outside) = middle;
+      }
+      return inside;
+    }
+    return qu_max_;
+  };
+  return boundary_table::sample(nv_, nw_, 2 * std::numbers::pi, period_w_, s_b);
+}
+
+std::shared_ptr<const boundary_table> domain_predicate::shared_table(
+    const std::string& key, const std::function<boundary_table()>& build) {
+  static std::mutex mutex;
+  static std::map<std::string, std::shared_ptr<const boundary_table>> tables;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& table = tables[key];
+  if (!table) table = std::make_shared<const boundary_table>(build());
+  return table;
+}
@@ -0,0 +1,94 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/domain_predicate.hh, this file is part of gtrace.
+
+#ifndef GTRACE_DOMAIN_PREDICATE
+#define GTRACE_DOMAIN_PREDICATE
+
+#include <gtrace/boxes/q_predicate.hh>
+#include <gtrace/tools/boundary_table.hh>
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+/*!
+Conditional integration within a 3D domain bounded by a tabulated surface.
+--------------------------------------------------------------------------
+
+A `q_predicate` (all of whose options and output apply) that breaks the time
+integration also once the gyron's position crosses the surface `qu=s_b(qv,qw)`,
+held as a `boundary_table` and evaluated by bilinear interpolation (a few
+nanoseconds per step). The surface is either read from the file given by
+`-domain-table` (flux coordinates) or derived from a Cartesian box
+`-domain-box=xmin:xmax:ymin:ymax:zmin:zmax` (SI, connected metrics only): for
+each `(qv,qw)` node, `s_b` is the smallest `qu` in `[0,domain-qu]` where the
+position leaves the box, found by scanning `qu` in `-domain-scan` intervals and
+bisecting the first crossing (or `domain-qu`, if the position never leaves it).
+Boxes are thus represented exactly only if each radial ray crosses their
+boundary once, ie, if they hold the magnetic axis. Tables are cached per process
+under the options they derive from: a file is read when the options naming it
+are parsed (once for all gyrons sharing them, see `observer_builder_t`), and a
+box is sampled on the first step of the first orbit traced with it (the shared
+options fix the field, thus any thread's field box will do), all later orbits
+sharing the same table.
+
+Observer options:
+
+ + `-domain-box=list` Cartesian box, as `xmin:xmax:ymin:ymax:zmin:zmax`.
+ + `-domain-grid=nv:nw` Nodes of the table built from a box (default 64:64).
+ + `-domain-period=val` Period of `qw` (default $2\pi$, ie, one field period).
+ + `-domain-qu=val` Largest `qu` searched within a box (default 1).
+ + `-domain-scan=val` Intervals scanned along `qu` within a box (default 64).
+ + `-domain-table=file` Table of `s_b` (see `boundary_table::read()`).
+!*/
+class domain_predicate : public q_predicate {
+ public:
+  struct box_t {
+    double x_min, x_max, y_min, y_max, z_min, z_max;
+  };
+  struct settings_t {
+    q_predicate::settings_t predicate;
+    std::optional<box_t> box;
+    std::string table_filename;
+    std::shared_ptr<const boundary_table> table;
+    size_t nv, nw, scan_intervals;
+    double period_w, qu_max;
+  };
+  static settings_t parse_settings(const argh::parser& arghs);
+  static settings_t parse_settings(
+      const argh::parser& arghs, const settings_t& base_settings);
+  domain_predicate() = delete;
+  domain_predicate(const settings_t& settings, std::ostream& os);
+  virtual ~domain_predicate() {};
+  virtual bool operator()(
+      const pusher_box_t* pusher, double time) const override;
+ protected:
+  virtual bool is_within_bounds(const IR3& q) const override;
+ private:
+  const std::optional<box_t> box_;
+  const size_t nv_, nw_, scan_intervals_;
+  const double period_w_, qu_max_;
+  mutable std::shared_ptr<const boundary_table> table_;
+  std::string compose_box_key() const;
+  boundary_table sample_box(const field_box_t* field) const;
+  static std::shared_ptr<const boundary_table> shared_table(
+      const std::string& key, const std::function<boundary_table()>& build);
+};
+
+#endif  // GTRACE_DOMAIN_PREDICATE
@@ -0,0 +1,102 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/drift_monitor.cc, this file is part of gtrace.
+
+#include <gtrace/boxes/drift_monitor.hh>
+#include <gtrace/tools/layered_arghs.hh>
+#include <gtrace/tools/text_record.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+drift_monitor::drift_monitor(const settings_t& settings, std::ostream& os)
+    : observer_box_t(os), is_abort_(settings.abort),
+      checked_fields_(settings.fields), gyron_id_(settings.gyron_id),
+      interval_(std::max<size_t>(settings.interval, 1)),
+      tolerance_(settings.tolerance),
+      exceeded_time_(std::numeric_limits<double>::quiet_NaN()) {}
+
+void drift_monitor::flush() const {
+  if (steps_ == 0) return;
+  ostream_ << "# drift: " << (gyron_id_.empty() ? "" : "id ")
+           << "tfinal texceeded";
+  std::istringstream fields_stream(fields_);
+  for (std::string field; fields_stream >> field;) ostream_ << " " << field;
+  ostream_ << " status\n";
+  if (!gyron_id_.empty()) ostream_ << gyron_id_ << " ";
+  std::list<double> record = {time_, exceeded_time_};
+  record.insert(record.end(), max_drifts_.begin(), max_drifts_.end());
+  bool is_exceeded = !std::isnan(exceeded_time_);
+  record.push_back(is_exceeded ? (is_abort_ ? 2 : 1) : 0);
+  text_record::write(ostream_, record);
+  steps_ = 0;
+}
+
+bool drift_monitor::operator()(const pusher_box_t* pusher, double time) const {
+  time_ = time;
+  if (steps_++ % interval_ != 0) return true;
+  std::list<double> values = pusher->compose_invariant_values(time);
+  if (initial_values_.empty()) {
+    fields_ = pusher->compose_invariant_fields();
+    std::istringstream fields_stream(fields_);
+    for (std::string field; fields_stream >> field;)
+      is_checked_.push_back(
+          checked_fields_.empty() ||
+          std::ranges::find(checked_fields_, field) != checked_fields_.end());
+    initial_values_.assign(values.begin(), values.end());
+    max_drifts_.assign(values.size(), 0);
+    return true;
+  }
+  size_t i = 0;
+  bool is_exceeded = false;
+  for (double value : values) {
+    double reference = initial_values_[i];
+    double drift = std::abs(value - reference) /
+                   (reference != 0 ? std::abs(reference) : 1);
+    max_drifts_[i] = std::max(max_drifts_[i], drift);
+    is_exceeded = is_exceeded || (is_checked_[i] && !(drift <= tolerance_));
+    i++;
+  }
+  if (is_exceeded && std::isnan(exceeded_time_)) exceeded_time_ = time;
+  return !(is_exceeded && is_abort_);
+}
+
+drift_monitor::settings_t drift_monitor::parse_settings(
+    const argh::parser& arghs) {
+  return parse_settings(
+      arghs, {.abort = false, .fields = {}, .gyron_id = "", .interval = 16,
+              .tolerance = 1e-3});
+}
+
+drift_monitor::settings_t drift_monitor::parse_settings(
+    const argh::parser& arghs, const settings_t& base) {
+  settings_t settings = base;
+  settings.abort = layered_flag(arghs, "drift-abort", base.abort);
+  std::string list;
+  if (arghs("drift-fields") >> list) {
+    settings.fields.clear();
+    std::istringstream list_stream(list);
+    for (std::string field; std::getline(list_stream, field, ',');)
+      settings.fields.push_back(field);
+  }
+  arghs("drift-interval", base.interval) >> settings.interval;
+  arghs("drift-tolerance", base.tolerance) >> settings.tolerance;
+  arghs("gyron-id", base.gyron_id) >> settings.gyron_id;
+  return settings;
+}
@@ -0,0 +1,87 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/drift_monitor.hh, this file is part of gtrace.
+
+#ifndef GTRACE_DRIFT_MONITOR
+#define GTRACE_DRIFT_MONITOR
+
+#include <gtrace/boxes/observer_box.hh>
+
+#include <string>
+#include <vector>
+
+/*!
+Monitor of the drift of conserved quantities along the orbit.
+-------------------------------------------------------------
+
+Samples, every `-drift-interval` time steps, the quantities the pusher conserves
+(see `pusher_box_t::compose_invariant_fields()`, eg, the total energy, the
+toroidal canonical momentum `Pphi` in axisymmetric fields, or the magnetic
+moment `mu` of full orbits) and tracks the largest relative drift of each from
+its initial value (absolute, for quantities starting at zero). An orbit whose
+drift of any of the invariants listed by `-drift-fields` (all, by default)
+exceeds `-drift-tolerance` is flagged and, with `-drift-abort`, stopped right
+away, so that diverging orbits waste no further compute; the drifts of the other
+invariants (eg, the adiabatic `mu`) are only reported. Once the orbit ends,
+`flush()` writes a single row preceded by the line `# drift:` naming its
+columns: the gyron's `-gyron-id` (set by the ensemble drivers, if any), the time
+of the last step, the time the tolerance was first exceeded (`nan` if never),
+the largest drift of each invariant, and the status (0 for conserved, 1 for
+flagged, 2 for aborted). Flagged gyrons are thus selected for a rerun with
+smaller time steps from the rows holding a non-zero status, whatever the order
+of the output blocks.
+
+Observer options:
+
+ + `-drift-abort` Stops the orbits exceeding the tolerance (default flags only).
+ + `-drift-fields=list` Comma-separated invariants checked (default all).
+ + `-drift-interval=val` Time steps between samples (default 16).
+ + `-drift-tolerance=val` Largest acceptable relative drift (default 1e-3).
+ + `-gyron-id=val` Gyron identifier heading the drift row (default none).
+!*/
+class drift_monitor : public observer_box_t {
+ public:
+  struct settings_t {
+    bool abort;
+    std::vector<std::string> fields;
+    std::string gyron_id;
+    size_t interval;
+    double tolerance;
+  };
+  static settings_t parse_settings(const argh::parser& arghs);
+  static settings_t parse_settings(
+      const argh::parser& arghs, const settings_t& base_settings);
+  drift_monitor() = delete;
+  drift_monitor(const settings_t& settings, std::ostream& os);
+  virtual ~drift_monitor() {};
+  virtual bool operator()(
+      const pusher_box_t* pusher, double time) const override;
+  virtual void flush() const override;
+ private:
+  const bool is_abort_;
+  const std::vector<std::string> checked_fields_;
+  const std::string gyron_id_;
+  const size_t interval_;
+  const double tolerance_;
+  mutable size_t steps_ = 0;
+  mutable double time_, exceeded_time_;
+  mutable std::string fields_;
+  mutable std::vector<bool> is_checked_;
+  mutable std::vector<double> initial_values_, max_drifts_;
+};
+
+#endif  // GTRACE_DRIFT_MONITOR
@@ -19,12 +19,36 @@
 #include <gyronimo/version.hh>
 
 #include <gtrace/boxes/driver_box.hh>
+#include <gtrace/tools/gzip_ostream.hh>
+#include <gtrace/tools/reduction_registry.hh>
 
 #include <chrono>
 #include <sstream>
+#include <stdexcept>
 
 driver_box_t::driver_box_t(int argc, char* argv[])
-    : argh_line_(argh::parser(argc, argv)) {}
+    : argh_line_(argh::parser(argc, argv)),
+      start_time_(std::chrono::steady_clock::now()) {
+  argh_line_("walltime", 0) >> walltime_;
+  argh_line_("walltime-margin", 0.1 * walltime_) >> walltime_margin_;
+}
+
+double driver_box_t::elapsed_walltime() const {
+  auto now = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(now - start_time_).count();
+}
+
+std::unique_ptr<gzip_ostream> driver_box_t::get_compressed_stream(
+    std::ostream& os) const {
+  int level;
+  if (!(argh_line_("compress") >> level)) return nullptr;
+#ifdef GTRACE_NO_ZLIB
+  throw std::invalid_argument("-compress needs gtrace built with zlib.");
+#endif
+  size_t n_threads;
+  argh_line_("compress-threads", 2) >> n_threads;
+  return std::make_unique<gzip_ostream>(os.rdbuf(), level, n_threads);
+}
 
 std::string driver_box_t::header_string(int argc, char* argv[]) {
   std::ostringstream header;
@@ -39,15 +63,72 @@ std::string driver_box_t::header_string(int argc, char* argv[]) {
 }
 
 std::string driver_box_t::integrate_orbit(
-    pusher_box_t* pusher, const observer_box_t* observer, double tfinal) const {
+    pusher_box_t* pusher, const observer_box_t* observer, double tfinal,
+    bool* is_interrupted, double* elapsed) const {
   auto tick_0 = std::chrono::steady_clock::now();
   double time = 0;
-  while ((*observer)(pusher, time) && time <= tfinal)
+  bool is_stopped = false;
+  for (size_t step = 1; (*observer)(pusher, time) && time <= tfinal; step++) {
+    if (step % walltime_check_steps_ == 0 && this->is_out_of_time()) {
+      is_stopped = true;
+      break;
+    }
     time = pusher->push_state(time);
+  }
   auto tick_1 = std::chrono::steady_clock::now();
-  if (argh_line_["peek-beyond-tfinal"]) (*observer)(pusher, time);
+  if (is_interrupted) *is_interrupted = is_stopped;
+  double seconds = std::chrono::duration<double>(tick_1 - tick_0).count();
+  if (elapsed) *elapsed = seconds;
+  if (!is_stopped && argh_line_["peek-beyond-tfinal"])
+    (*observer)(pusher, time);
+  observer->flush();
   std::ostringstream elapsed_time_line;
   elapsed_time_line << "# elapsed time: "
                     << std::chrono::duration<double>(tick_1 - tick_0);
   return elapsed_time_line.str();
 }
+
+bool driver_box_t::is_draining() const {
+  return this->has_walltime() &&
+         this->elapsed_walltime() > walltime_ - walltime_margin_;
+}
+
+bool driver_box_t::is_out_of_time() const {
+  return this->has_walltime() &&
+         this->elapsed_walltime() > walltime_ - 0.5 * walltime_margin_;
+}
+
+double driver_box_t::probe_orbit_cost(
+    pusher_box_t* pusher, double tfinal, double probe_fraction,
+    const observer_builder_t& observer_builder,
+    const argh::parser& private_arghs) const {
+  std::ostream null_stream(nullptr);
+  reduction_registry::discarding_scope discarding;
+  auto observer = observer_builder(private_arghs, null_stream);
+  double probe_time = probe_fraction * tfinal, time = 0;
+  auto tick_0 = std::chrono::steady_clock::now();
+  while ((*observer)(pusher, time) && time <= probe_time)
+    time = pusher->push_state(time);
+  auto tick_1 = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double>(tick_1 - tick_0).count();
+  return (time > probe_time ? elapsed / probe_fraction : elapsed);
+}
+
+std::string driver_box_t::walltime_summary(
+    const walltime_tally_t& tally) const {
+  std::ostringstream summary;
+  summary << "# walltime summary: completed=" << tally.completed
+          << " interrupted=" << tally.interrupted
+          << " not-started=" << tally.not_started
+          << " elapsed=" << this->elapsed_walltime();
+  return summary.str();
+}
+
+bool driver_box_t::has_reductions() const {
+  register_linked_reductions(argh_line_);
+  return !reduction_registry::global().empty();
+}
+
+void driver_box_t::write_reductions(std::ostream& os) const {
+  for (auto& entry : reduction_registry::global().reduce()) entry->write(os);
+}
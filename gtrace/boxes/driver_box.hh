@@ -23,18 +23,60 @@
 #include <gtrace/boxes/pusher_box.hh>
 #include <gtrace/tools/argh.h>
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
 
+class gzip_ostream;
+
 /*!
 Base class for gyron-integration drivers.
 -----------------------------------------
 
 Options:
 
+ + `-compress=val` Compresses the output in gzip format at this level (1-9).
+ + `-compress-threads=val` Threads compressing the output (default 2).
  + `-peek-beyond-tfinal`\
     Invokes the observer also on the state that is pushed one time step beyond
     the integration limit `tfinal`.
+ + `-walltime=val` Wall-clock budget of the run in seconds (default none).
+ + `-walltime-margin=val` Time reserved to drain the run (default 10%).
+
+With `-walltime`, the run drains gracefully before the budget runs out, instead
+of being killed by the batch system with its output buffers and in-flight orbits
+lost: once less than `-walltime-margin` seconds remain, drivers take no more
+gyrons (`is_draining()`); when only half the margin remains, in-flight orbits
+are interrupted (`is_out_of_time()`), their output blocks closed with the line
+`walltime_mark_`, and the remaining time is left to flush the output (drivers
+flush it as the drain starts, so that even compressed output is readable up to
+there if the run gets killed anyway). Drivers then print `walltime_summary()`, a
+single machine-readable line with the number of gyrons completed, interrupted,
+and never started in the run. Interrupted gyrons are never committed to
+completion journals, so a resumed run integrates them again.
+
+`probe_orbit_cost()` predicts the wall-clock cost of an orbit from a short probe
+integration up to `probe_fraction*tfinal`, with the output of the observer
+(built by `observer_builder` from the gyron's `private_arghs`) discarded: the
+probe's elapsed time is extrapolated to `tfinal`, unless the observer stops the
+orbit earlier (in which case the probe is the whole orbit).
+
+With `-compress`, the ensemble drivers write their output through a
+`gzip_ostream` returned by `get_compressed_stream()`, compressed by background
+threads while the orbits are integrated, to `std::cout` or to files with the
+additional extension `.gz` (read back by `zcat`, python's `gzip` module, etc). A
+gtrace built with `GTRACE_ZLIB=no` (no zlib) rejects `-compress`.
+
+Observers accumulating over the whole ensemble (eg, `phase_deposition`) keep
+thread-local copies in the `reduction_registry`; at the end of the run, drivers
+call `write_reductions()`, which sums the copies and writes the results to the
+output (the MPI drivers override it to sum also over processes, written by rank
+0 alone). `has_reductions()` registers in the calling thread the entries of the
+observer built from the shared options (so that processes without gyrons still
+take part in the MPI sums) and tells whether there are any. Completion journals
+hold output blocks only, thus a resumed run could not restore the sums over the
+gyrons completed before: the drivers refuse `-journal` with such observers.
 !*/
 class driver_box_t {
  public:
@@ -44,10 +86,30 @@ class driver_box_t {
   virtual ~driver_box_t() {};
   virtual int operator()(int argc, char* argv[]) const = 0;
   virtual std::string integrate_orbit(
-      pusher_box_t* pusher, const observer_box_t* observer,
-      double tfinal) const;
+      pusher_box_t* pusher, const observer_box_t* observer, double tfinal,
+      bool* is_interrupted = nullptr, double* elapsed = nullptr) const;
+  double probe_orbit_cost(
+      pusher_box_t* pusher, double tfinal, double probe_fraction,
+      const observer_builder_t& observer_builder,
+      const argh::parser& private_arghs) const;
  protected:
+  struct walltime_tally_t {
+    std::atomic<size_t> completed = 0, interrupted = 0, not_started = 0;
+  };
+  static constexpr char walltime_mark_[] = "# interrupted by the walltime.";
+  static constexpr size_t walltime_check_steps_ = 64;
   const argh::parser argh_line_;
+  std::unique_ptr<gzip_ostream> get_compressed_stream(std::ostream& os) const;
+  bool has_walltime() const { return walltime_ > 0; };
+  bool is_draining() const;
+  bool is_out_of_time() const;
+  std::string walltime_summary(const walltime_tally_t& tally) const;
+  bool has_reductions() const;
+  virtual void write_reductions(std::ostream& os) const;
+ private:
+  const std::chrono::steady_clock::time_point start_time_;
+  double walltime_, walltime_margin_;
+  double elapsed_walltime() const;
 };
 
 std::unique_ptr<driver_box_t> create_linked_driver_box(int argc, char* argv[]);
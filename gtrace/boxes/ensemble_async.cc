@@ -17,61 +17,345 @@
 // @boxes/ensemble_async.cc, this file is part of gtrace.
 
 #include <gtrace/boxes/ensemble_async.hh>
+#include <gtrace/tools/bounded_queue.hh>
+#include <gtrace/tools/chunked_streambuf.hh>
+#include <gtrace/tools/columnar_ensemble.hh>
+#include <gtrace/tools/completion_journal.hh>
+#include <gtrace/tools/gzip_ostream.hh>
+#include <gtrace/tools/locality_order.hh>
+#include <gtrace/tools/numa_topology.hh>
+#include <gtrace/tools/reorder_buffer.hh>
+#include <gtrace/tools/spsc_ring.hh>
 
-#include <execution>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
 #include <iostream>
-#include <syncstream>
-
-auto ensemble_async::get_boxes(
-    const argh::parser& arghs, std::ostream& os) const {
-  auto field = create_linked_field_box(arghs);
-  auto pusher = create_linked_pusher_box(arghs, field.get());
-  auto observer = create_linked_observer_box(arghs, os);
-  return std::tuple(std::move(field), std::move(pusher), std::move(observer));
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+
+ensemble_async::ensemble_async(int argc, char* argv[])
+    : driver_box_t(argc, argv),
+      pusher_builder_(create_linked_pusher_builder(argh_line_)),
+      observer_builder_(create_linked_observer_builder(argh_line_)) {
+  argh_line_("tfinal", 1) >> time_final_;
+  argh_line_("cost-probe", 0) >> cost_probe_;
+  std::string cost_filename;
+  if (argh_line_("cost-file") >> cost_filename)
+    cost_table_ = std::make_unique<cost_table>(cost_filename);
+}
+
+std::vector<size_t> ensemble_async::dispatch_order(
+    const std::vector<gyron_task_t>& tasks,
+    bounded_queue<gyron_task_t>& input_queue) const {
+  if (cost_table_ || cost_probe_ > 0)
+    return longest_first_order(this->predict_costs(tasks, input_queue));
+  std::vector<gyron_ic_t> initial_conditions;
+  for (const gyron_task_t& task : tasks)
+    initial_conditions.push_back(std::visit(
+        [&](const auto& input) {
+          return pusher_builder_->initial_condition(input);
+        },
+        task.input));
+  return locality_order(initial_conditions);
 }
 
-std::vector<std::string> ensemble_async::get_option_lines_from_file(
+std::ifstream ensemble_async::get_input_stream(
     const argh::parser& arghs) const {
   std::string filename;
   arghs("ensemble-file", "") >> filename;
   std::ifstream in_stream(filename);
   if (!in_stream.is_open())
     throw std::runtime_error("cannot read from file " + filename + ".\n");
+  return in_stream;
+}
 
-  std::vector<std::string> option_lines;
-  for (std::string line; std::getline(in_stream, line);)
-    option_lines.emplace_back(line);
-  return option_lines;
+bool ensemble_async::integrate_gyron(
+    const std::string& id, const std::string& private_options,
+    const field_box_t* field, std::ostream& os, double& cost) const {
+  auto private_arghs = argh::parser(private_options + " -gyron-id=" + id);
+  auto pusher = (*pusher_builder_)(private_arghs, field);
+  double time_final;
+  private_arghs("tfinal", time_final_) >> time_final;
+  return this->integrate_gyron(
+      pusher.get(), private_arghs, time_final, os, cost);
 }
 
-int ensemble_async::operator()(int argc, char* argv[]) const {
-  std::cout << this->header_string(argc, argv) << "\n";
+bool ensemble_async::integrate_gyron(
+    const std::string& id, const gyron_ic_t& initial_condition,
+    const field_box_t* field, std::ostream& os, double& cost) const {
+  auto pusher = (*pusher_builder_)(initial_condition, field);
+  os << gyron_ic_header(initial_condition) << "\n";
+  return this->integrate_gyron(
+      pusher.get(), argh::parser("-gyron-id=" + id), time_final_, os, cost);
+}
+
+bool ensemble_async::integrate_gyron(
+    pusher_box_t* pusher, const argh::parser& private_arghs, double time_final,
+    std::ostream& os, double& cost) const {
+  os << pusher->compose_output_fields() << "\n";
   if (argh_line_["sci-16"]) {
-    std::cout.precision(16);
-    std::cout.setf(std::ios::scientific);
+    os.precision(16);
+    os.setf(std::ios::scientific);
   }
-  std::string shared_options = this->convert_argv_to_string(argv);
-  auto private_option_lines = this->get_option_lines_from_file(argh_line_);
-  std::for_each(
-      std::execution::par, private_option_lines.begin(),
-      private_option_lines.end(),
-      [&shared_options, this](const std::string& private_options) {
-        std::osyncstream out_stream(std::cout);
-        auto arghs = argh::parser(shared_options + private_options);
-        auto [field, pusher, observer] = this->get_boxes(arghs, out_stream);
-        out_stream << pusher->compose_output_fields() << "\n";
-
-        double time_final;
-        arghs("tfinal", 1) >> time_final;
-        std::string elapsed_time_info =
-            this->integrate_orbit(pusher.get(), observer.get(), time_final);
-        if (argh_line_["elapsed-time"]) out_stream << elapsed_time_info << "\n";
-      });
-  return 0;
+  auto observer = (*observer_builder_)(private_arghs, os);
+
+  bool is_interrupted = false;
+  std::string elapsed_time_info = this->integrate_orbit(
+      pusher, observer.get(), time_final, &is_interrupted, &cost);
+  if (argh_line_["elapsed-time"]) os << elapsed_time_info << "\n";
+  if (is_interrupted) os << walltime_mark_ << "\n";
+  return !is_interrupted;
+}
+
+std::vector<double> ensemble_async::predict_costs(
+    const std::vector<gyron_task_t>& tasks,
+    bounded_queue<gyron_task_t>& input_queue) const {
+  std::vector<double> costs(tasks.size(), 0);
+  std::vector<size_t> probed;
+  for (size_t i = 0; i < tasks.size(); i++) {
+    auto recorded_cost =
+        (cost_table_ ? (*cost_table_)(tasks[i].id) : std::nullopt);
+    if (recorded_cost) costs[i] = *recorded_cost;
+    else if (cost_probe_ > 0) probed.push_back(i);
+  }
+  std::latch pending_probes(probed.size());
+  for (size_t i : probed)
+    input_queue.push(
+        {.index = tasks[i].index, .id = tasks[i].id, .input = tasks[i].input,
+         .probed_cost = &costs[i], .pending_probes = &pending_probes});
+  pending_probes.wait();
+  return costs;
+}
+
+double ensemble_async::probe_cost(
+    const std::string& private_options, const field_box_t* field) const {
+  auto private_arghs = argh::parser(private_options);
+  auto pusher = (*pusher_builder_)(private_arghs, field);
+  double time_final;
+  private_arghs("tfinal", time_final_) >> time_final;
+  return this->probe_orbit_cost(
+      pusher.get(), time_final, cost_probe_, *observer_builder_,
+      private_arghs);
+}
+
+double ensemble_async::probe_cost(
+    const gyron_ic_t& initial_condition, const field_box_t* field) const {
+  auto pusher = (*pusher_builder_)(initial_condition, field);
+  return this->probe_orbit_cost(
+      pusher.get(), time_final_, cost_probe_, *observer_builder_,
+      argh::parser());
 }
 
-std::string ensemble_async::convert_argv_to_string(char* argv[]) const {
-  std::ostringstream stream;
-  for (auto p = argv; *p; ++p) stream << *p << " ";
-  return stream.str();
+int ensemble_async::operator()(int argc, char* argv[]) const {
+  auto compressed = this->get_compressed_stream(std::cout);
+  std::ostream& result_stream = (compressed ? *compressed : std::cout);
+  result_stream << this->header_string(argc, argv) << "\n";
+  std::string binary_filename;
+  auto ensemble = (argh_line_("ensemble-binary") >> binary_filename
+                       ? std::make_unique<columnar_ensemble>(binary_filename)
+                       : nullptr);
+  std::ifstream in_stream =
+      (ensemble ? std::ifstream() : this->get_input_stream(argh_line_));
+  std::string journal_filename;
+  bool is_journaled = !!(argh_line_("journal") >> journal_filename);
+  if (is_journaled && this->has_reductions())
+    throw std::invalid_argument("-journal cannot resume ensemble reductions.");
+  auto journal = (is_journaled
+                      ? std::make_unique<completion_journal>(journal_filename)
+                      : nullptr);
+  if (journal) completion_journal::replay(journal_filename, result_stream);
+
+  size_t n_threads = std::max(1u, std::thread::hardware_concurrency());
+  argh_line_("threads", n_threads) >> n_threads;
+  size_t queue_size = 4 * n_threads;
+  argh_line_("queue-size", queue_size) >> queue_size;
+  bounded_queue<gyron_task_t> input_queue(queue_size);
+  size_t window_size;
+  if (cost_table_ || cost_probe_ > 0)
+    argh_line_("cost-window", 1024) >> window_size;
+  else argh_line_("locality-window", 0) >> window_size;
+  bool is_reordered = (window_size > 1);
+  bool is_ordered = (is_reordered || argh_line_["ordered"]);
+  size_t reorder_memory;
+  argh_line_("reorder-memory", 1024) >> reorder_memory;
+  std::string spill_filename;
+  argh_line_(
+      "reorder-spill", (std::filesystem::temp_directory_path() /
+                        ("gtrace-" + std::to_string(getpid()) + ".spill"))
+                           .string()) >>
+      spill_filename;
+  std::string cost_filename;
+  std::ofstream cost_stream;
+  if (argh_line_("cost-output") >> cost_filename)
+    cost_stream.open(cost_filename, std::ios::app);
+  size_t chunk_size, chunks_per_thread;
+  argh_line_("chunk-size", 65536) >> chunk_size;
+  argh_line_("chunks-per-thread", 64) >> chunks_per_thread;
+  std::vector<std::unique_ptr<spsc_ring<gyron_output_t>>> channels;
+  for (size_t i = 0; i < n_threads; i++)
+    channels.push_back(
+        std::make_unique<spsc_ring<gyron_output_t>>(chunks_per_thread));
+  std::atomic<size_t> activity = 0, finished_workers = 0;
+  bool is_streamed = (!journal && !is_ordered);
+  walltime_tally_t tally;
+  auto topology =
+      (argh_line_["numa"] ? std::make_unique<numa_topology>() : nullptr);
+
+  std::jthread reader([&]() {
+    size_t index = 0;
+    std::vector<gyron_task_t> window;
+    auto flush_window = [&]() {
+      for (size_t i : this->dispatch_order(window, input_queue))
+        input_queue.push(std::move(window[i]));
+      window.clear();
+    };
+    auto enqueue = [&](std::string&& id, auto&& input) {
+      if (journal && journal->is_completed(id)) return;
+      if (this->is_draining()) {
+        tally.not_started++;
+        return;
+      }
+      gyron_task_t task = {index++, std::move(id), std::move(input)};
+      if (!is_reordered) {
+        input_queue.push(std::move(task));
+        return;
+      }
+      window.push_back(std::move(task));
+      if (window.size() == window_size) flush_window();
+    };
+    if (ensemble)
+      for (size_t i = 0; i < ensemble->size(); i++)
+        enqueue(std::to_string((uint64_t)(*ensemble)[i].id), (*ensemble)[i]);
+    else {
+      size_t line_index = 0;
+      for (std::string line; std::getline(in_stream, line);)
+        enqueue(std::to_string(line_index++), std::move(line));
+    }
+    flush_window();
+    input_queue.close();
+  });
+  std::jthread writer([&]() {
+    std::unordered_map<size_t, std::string> partial_blocks;
+    reorder_buffer pending_blocks(reorder_memory << 20, spill_filename);
+    std::optional<size_t> streaming_channel;
+    auto write_record = [&](size_t channel, gyron_output_t& output) {
+      if (is_streamed) {
+        result_stream << output.chunk;
+        streaming_channel =
+            (output.is_last ? std::nullopt : std::optional(channel));
+      } else partial_blocks[output.index] += output.chunk;
+      if (!output.is_last) return;
+      bool is_completed = (output.outcome == outcome_t::completed);
+      if (is_completed) tally.completed++;
+      else if (output.outcome == outcome_t::interrupted) tally.interrupted++;
+      else tally.not_started++;
+      if (is_completed && cost_stream.is_open())
+        cost_stream << output.id << " " << output.cost << "\n";
+      if (is_streamed) return;
+      auto node = partial_blocks.extract(output.index);
+      if (journal && is_completed) journal->commit(output.id, node.mapped());
+      if (!is_ordered) {
+        result_stream << node.mapped();
+        return;
+      }
+      pending_blocks.put(output.index, std::move(node.mapped()));
+      pending_blocks.release(
+          [&](const std::string& block) { result_stream << block; });
+    };
+    bool is_drain_flushed = false;
+    while (true) {
+      if (!is_drain_flushed && this->is_draining()) {
+        result_stream.flush();
+        is_drain_flushed = true;
+      }
+      size_t seen_activity = activity.load();
+      size_t n_finished = finished_workers.load();
+      bool is_idle = true;
+      for (size_t i = 0; i < n_threads; i++) {
+        if (streaming_channel && *streaming_channel != i) continue;
+        while (auto output = channels[i]->try_pop()) {
+          is_idle = false;
+          write_record(i, *output);
+          if (output->is_last) break;
+        }
+      }
+      if (!is_idle) continue;
+      if (n_finished == n_threads) break;
+      activity.wait(seen_activity);
+    }
+    result_stream.flush();
+  });
+  {
+    std::vector<std::jthread> workers;
+    for (size_t i = 0; i < n_threads; i++)
+      workers.emplace_back([&, i]() {
+        if (topology) topology->bind_thread(topology->domain_of(i));
+        double blocked_time = 0;
+        auto send = [&](gyron_output_t&& output) {
+          auto tick_0 = std::chrono::steady_clock::now();
+          channels[i]->push(std::move(output));
+          auto tick_1 = std::chrono::steady_clock::now();
+          blocked_time +=
+              std::chrono::duration<double>(tick_1 - tick_0).count();
+          activity++;
+          activity.notify_one();
+        };
+        size_t index;
+        std::string id;
+        chunked_streambuf out_buffer(chunk_size, [&](std::string&& chunk) {
+          send({index, id, std::move(chunk), 0, false, outcome_t::completed});
+        });
+        auto field = create_linked_field_box(argh_line_);
+        while (auto task = input_queue.pop()) {
+          if (task->probed_cost) {
+            if (!this->is_draining())
+              *task->probed_cost = std::visit(
+                  [&](const auto& gyron) {
+                    return this->probe_cost(gyron, field.get());
+                  },
+                  task->input);
+            task->pending_probes->count_down();
+            continue;
+          }
+          index = task->index, id = task->id;
+          if (this->is_draining()) {
+            send(
+                {.index = index, .id = std::move(task->id), .chunk = "",
+                 .cost = 0, .is_last = true,
+                 .outcome = outcome_t::not_started});
+            continue;
+          }
+          std::ostream out_stream(&out_buffer);
+          double cost;
+          blocked_time = 0;
+          bool is_completed = std::visit(
+              [&](const auto& gyron) {
+                return this->integrate_gyron(
+                    id, gyron, field.get(), out_stream, cost);
+              },
+              task->input);
+          out_buffer.flush_chunk();
+          send(
+              {.index = index, .id = std::move(task->id), .chunk = "",
+               .cost = std::max(cost - blocked_time, 0.0), .is_last = true,
+               .outcome =
+                   (is_completed ? outcome_t::completed
+                                 : outcome_t::interrupted)});
+        }
+        finished_workers++;
+        activity++;
+        activity.notify_one();
+      });
+  }
+  writer.join();
+  this->write_reductions(result_stream);
+  if (this->has_walltime())
+    result_stream << this->walltime_summary(tally) << std::endl;
+  if (compressed) compressed->close();
+  return 0;
 }
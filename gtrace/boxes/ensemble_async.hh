@@ -20,11 +20,16 @@
 #define GTRACE_ENSEMBLE_ASYNC
 
 #include <gtrace/boxes/driver_box.hh>
+#include <gtrace/tools/cost_table.hh>
 
 #include <fstream>
+#include <latch>
 #include <string>
+#include <variant>
 #include <vector>
 
+template<typename T> class bounded_queue;
+
 /*!
 Asynchronous integration of a gyron ensemble.
 ---------------------------------------------
@@ -32,26 +37,147 @@ Asynchronous integration of a gyron ensemble.
 Integrates a collection (ensemble) of gyrons (ie, particles, guiding centres,
 etc) as defined by the state type of the invoked pusher_box. The integration is
 performed asynchronously (one gyron at a time) and individual pusher objects for
-each gyron in the collection are built from the concatenation of the options
-supplied at the command line (ie, the shared_options) with those at each line of
-the input file. If available, the `c++17` execution policy `std::execution::par`
-is employed to split the ensemble integration in parallel tasks.
+each gyron in the collection are built from the options supplied at the command
+line (ie, the shared options, parsed only once) overlaid by those at each line
+of the input file (the private options, which take precedence). Pusher and
+observer options and `-tfinal` may be private (observers are built likewise, see
+`observer_builder_t`), the field boxes are built from the shared options alone
+(one per worker thread). Alternatively, the initial conditions may be read from
+a binary columnar file (see `columnar_ensemble`), in which case pushers are
+built directly from the shared options and the file values, without any text
+parsing; each output block is then preceded by a line with the gyron's id and
+weight.
+
+The ensemble is streamed through a three-stage pipeline: a reader thread feeds
+the input lines into a bounded queue, a pool of worker threads integrates one
+gyron per line, and a writer thread sends the output to `std::cout`. Each
+worker writes its output into a `chunked_streambuf`, which hands it over in
+chunks of `-chunk-size` bytes through a lock-free `spsc_ring` private to that
+worker, holding at most `-chunks-per-thread` chunks; all i/o is performed by
+the writer thread alone. The writer streams the chunks of one gyron at a time
+to `std::cout`, so blocks never interleave, while a worker whose ring is full
+waits for the writer to catch up (backpressure). Both the memory footprint and
+the latency of the output are thus bounded, however long each orbit's output
+and the ensemble are; integration starts as soon as the first line is read.
+Each worker integrates its gyrons one at a time: orbits are not interleaved on
+a worker to hide the memory latency of the field, since the field is evaluated
+within gyronimo's equations of motion, which expose no point where an orbit
+could prefetch the data it needs and suspend until it arrives.
+
+With the option `-journal`, each finished output block is also committed to an
+append-only `completion_journal` (keyed by the line number or, for binary input,
+by the gyron id). A run restarted with the same journal first replays the
+outputs recorded therein to `std::cout` and then integrates only the gyrons not
+yet completed, so no finished orbit is ever integrated twice.
+
+With `-locality-window=n`, the reader gathers the gyrons in windows of `n`
+consecutive ones and dispatches each window sorted by the locality of their
+initial conditions (see `locality_order`), so that consecutive gyrons on the
+workers probe nearby regions of the field data, raising the hit rates of field
+caches. The writer then holds back the output blocks finished out of turn and
+sends them to `std::cout` in the original ensemble order. Output blocks are
+assembled as a whole in the writer whenever `-journal` or some ordering is
+active, the memory bound above holding then only for the workers.
+
+Otherwise, blocks are written in the order the gyrons finish, which changes from
+run to run. With `-ordered`, they are written in the ensemble order instead, so
+the output is reproducible and its n-th block matches the n-th gyron read (ie,
+not found in the journal). Blocks finished out of turn wait in a
+`reorder_buffer` holding at most `-reorder-memory` MiB, past which the blocks
+needed last are spilled to the file `-reorder-spill` (removed at the end), so
+that a straggling orbit neither stalls the workers nor exhausts the memory.
+
+Cost-aware scheduling starts the most expensive orbits first, so that long
+orbits do not end up alone at the tail of the run. It is enabled by either
+`-cost-file`, holding the costs recorded by a previous run with `-cost-output`
+(see `cost_table`), or `-cost-probe=f`, which predicts the cost of each gyron
+(not found in the cost file) from a short probe integration up to `f*tfinal`
+(see `driver_box_t::probe_orbit_cost()`). Probes are queued ahead of their
+window as tasks of their own and run by the workers themselves, within the
+`-threads` budget. Each window of `-cost-window` gyrons is then dispatched in
+decreasing order of cost (overriding `-locality-window`), while the output
+blocks are still written in the original ensemble order. The costs recorded by
+`-cost-output` time the orbit integration alone, without the time its worker
+waits for the writer to take the output.
+
+With `-numa`, the workers are spread round-robin over the NUMA domains of the
+process and pinned to them (see `numa_topology`). Each worker builds its own
+field box after pinning, so the field data is allocated and first touched on the
+worker's own node and all field calls read local memory.
+
+With `-walltime` (see `driver_box_t`), the reader stops feeding gyrons and the
+workers discard those still queued once the run starts draining, the writer
+flushes all finished and interrupted blocks, and the summary line is printed
+last to `std::cout`.
 
 Driver options:
 
+ + `-chunk-size=val` Size of the output chunks in bytes (default 65536).
+ + `-chunks-per-thread=val` Capacity of each worker's ring (default 64).
+ + `-compress=val` Compresses the output with gzip (see `driver_box_t`).
+ + `-cost-file=val` Costs recorded by a previous run (see `cost_table`).
+ + `-cost-output=val` Appends the cost of each finished gyron to this file.
+ + `-cost-probe=val` Fraction of `tfinal` integrated to predict costs.
+ + `-cost-window=val` Gyrons sorted together by cost (default 1024).
+ + `-elapsed-time` Prints the elapsed time for each orbit (default no print).
+ + `-ensemble-binary=val` Path to a binary columnar input file.
  + `-ensemble-file=val` Path to the input file, one set of options per line.
+ + `-journal=val` Path to the completion journal (created if missing).
+ + `-numa` Pins the worker threads to NUMA domains (see `numa_topology`).
+ + `-locality-window=val` Gyrons sorted together by locality (default none).
+ + `-ordered` Writes the output blocks in the ensemble order.
+ + `-queue-size=val` Capacity of the input queue (default 4*threads).
+ + `-reorder-memory=val` Memory of the reorder buffer in MiB (default 1024).
+ + `-reorder-spill=val` Spill file of the reorder buffer (default in `/tmp`).
+ + `-sci-16` Turns on 16-digit scientific format for numeric output.
  + `-tfinal=val` Time-integration limit (default 1, in `pusher_box_t` units).
+ + `-threads=val` Number of worker threads (defaults to the number of cores).
 !*/
 class ensemble_async : public driver_box_t {
  public:
-  ensemble_async(int argc, char* argv[]) : driver_box_t(argc, argv) {};
+  ensemble_async(int argc, char* argv[]);
   virtual ~ensemble_async() {};
   virtual int operator()(int argc, char* argv[]) const;
  private:
-  std::string convert_argv_to_string(char* argv[]) const;
-  auto get_boxes(const argh::parser& arghs, std::ostream& os) const;
-  std::vector<std::string> get_option_lines_from_file(
-      const argh::parser& arghs) const;
+  struct gyron_task_t {
+    size_t index;
+    std::string id;
+    std::variant<std::string, gyron_ic_t> input;
+    double* probed_cost = nullptr;
+    std::latch* pending_probes = nullptr;
+  };
+  enum class outcome_t { completed, interrupted, not_started };
+  struct gyron_output_t {
+    size_t index;
+    std::string id, chunk;
+    double cost;
+    bool is_last;
+    outcome_t outcome;
+  };
+  double time_final_, cost_probe_;
+  const std::unique_ptr<pusher_builder_t> pusher_builder_;
+  const std::unique_ptr<observer_builder_t> observer_builder_;
+  std::unique_ptr<cost_table> cost_table_;
+  std::vector<size_t> dispatch_order(
+      const std::vector<gyron_task_t>& tasks,
+      bounded_queue<gyron_task_t>& input_queue) const;
+  std::ifstream get_input_stream(const argh::parser& arghs) const;
+  bool integrate_gyron(
+      const std::string& id, const std::string& private_options,
+      const field_box_t* field, std::ostream& os, double& cost) const;
+  bool integrate_gyron(
+      const std::string& id, const gyron_ic_t& initial_condition,
+      const field_box_t* field, std::ostream& os, double& cost) const;
+  bool integrate_gyron(
+      pusher_box_t* pusher, const argh::parser& private_arghs,
+      double time_final, std::ostream& os, double& cost) const;
+  std::vector<double> predict_costs(
+      const std::vector<gyron_task_t>& tasks,
+      bounded_queue<gyron_task_t>& input_queue) const;
+  double probe_cost(
+      const std::string& private_options, const field_box_t* field) const;
+  double probe_cost(
+      const gyron_ic_t& initial_condition, const field_box_t* field) const;
 };
 
 #endif  // GTRACE_ENSEMBLE_ASYNC
@@ -17,64 +17,216 @@
 // @boxes/ensemble_async_mpi.cc, this file is part of gtrace.
 
 #include <gtrace/boxes/ensemble_async_mpi.hh>
+#include <gtrace/tools/columnar_ensemble.hh>
+#include <gtrace/tools/gzip_ostream.hh>
+#include <gtrace/tools/layered_arghs.hh>
+#include <gtrace/tools/locality_order.hh>
+#include <gtrace/tools/mpi_line_reader.hh>
+#include <gtrace/tools/reduction_registry.hh>
 
+#include <algorithm>
 #include <memory>
 #include <mpi.h>
+#include <sstream>
 
 ensemble_async_mpi::ensemble_async_mpi(int argc, char* argv[])
-    : driver_box_t(argc, argv) {
+    : driver_box_t(argc, argv),
+      pusher_builder_(create_linked_pusher_builder(argh_line_)) {
+  argh_line_("tfinal", 1) >> time_final_;
   MPI_Init(&argc, &argv);
   MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank_);
   MPI_Comm_size(MPI_COMM_WORLD, &mpi_size_);
+  observer_builder_ = create_linked_observer_builder(layered_arghs(
+      argh_line_, argh::parser("-mpi-rank=" + std::to_string(mpi_rank_))));
 }
 
 ensemble_async_mpi::~ensemble_async_mpi() { MPI_Finalize(); }
 
 int ensemble_async_mpi::operator()(int argc, char* argv[]) const {
-  auto [in_stream, out_stream] = this->get_io_streams(argh_line_, mpi_rank_);
+  std::ofstream file_stream = this->get_output_stream(argh_line_);
+  auto compressed = this->get_compressed_stream(file_stream);
+  std::ostream& out_stream =
+      (compressed ? *compressed : static_cast<std::ostream&>(file_stream));
   out_stream << this->header_string(argc, argv) << "\n";
+  auto journal = this->get_journal(argh_line_, out_stream);
+  auto is_completed = [&journal](const std::string& id) {
+    return journal && journal->is_completed(id);
+  };
 
-  std::string shared_options = this->convert_argv_to_string(argv);
-  for (std::string private_options; std::getline(in_stream, private_options);) {
-    auto full_arghs = argh::parser(shared_options + private_options);
-    auto field = create_linked_field_box(full_arghs);
-    auto pusher = create_linked_pusher_box(full_arghs, field.get());
-    auto observer = create_linked_observer_box(full_arghs, out_stream);
-
-    out_stream << pusher->compose_output_fields() << "\n";
-    if (argh_line_["sci-16"]) {
-      out_stream.precision(16);
-      out_stream.setf(std::ios::scientific);
-    }
+  auto field = create_linked_field_box(argh_line_);
+  walltime_tally_t tally;
+  auto skip_gyron = [&]() {
+    if (tally.not_started++ == 0) out_stream.flush();
+  };
+  std::string binary_filename;
+  auto ensemble = (argh_line_("ensemble-binary") >> binary_filename
+                       ? std::make_unique<columnar_ensemble>(binary_filename)
+                       : nullptr);
+  std::vector<std::pair<std::string, std::string>> option_lines;
+  if (!ensemble) option_lines = this->get_option_lines(argh_line_);
+  size_t begin = 0, end = option_lines.size();
+  if (ensemble) {
+    begin = ensemble->size() * mpi_rank_ / mpi_size_;
+    end = ensemble->size() * (mpi_rank_ + 1) / mpi_size_;
+  }
 
-    double time_final;
-    full_arghs("tfinal", 1) >> time_final;
-    std::string elapsed_time_info =
-        this->integrate_orbit(pusher.get(), observer.get(), time_final);
-    if (argh_line_["elapsed-time"]) out_stream << elapsed_time_info << "\n";
+  auto visit_gyron = [&](size_t i, const auto& action) {
+    if (ensemble)
+      action(std::to_string((uint64_t)(*ensemble)[i].id), (*ensemble)[i]);
+    else action(option_lines[i].first, option_lines[i].second);
+  };
+  auto integrate = [&](std::ostream& os) {
+    return [&](const std::string& id, const auto& input) {
+      if (is_completed(id)) return;
+      if (this->is_draining()) {
+        skip_gyron();
+        return;
+      }
+      bool is_finished =
+          this->integrate_gyron(id, input, field.get(), os, journal.get());
+      (is_finished ? tally.completed : tally.interrupted)++;
+    };
+  };
+  size_t window;
+  argh_line_("locality-window", 0) >> window;
+  window = std::max<size_t>(window, 1);
+  for (size_t first = begin; first < end; first += window) {
+    size_t last = std::min(first + window, end);
+    if (last - first == 1) {
+      visit_gyron(first, integrate(out_stream));
+      continue;
+    }
+    std::vector<gyron_ic_t> initial_conditions;
+    for (size_t i = first; i < last; i++)
+      visit_gyron(i, [&](const std::string&, const auto& input) {
+        initial_conditions.push_back(
+            pusher_builder_->initial_condition(input));
+      });
+    std::vector<std::ostringstream> blocks(last - first);
+    for (size_t k : locality_order(initial_conditions))
+      visit_gyron(first + k, integrate(blocks[k]));
+    for (const std::ostringstream& block : blocks) out_stream << block.str();
+    if (this->is_draining()) out_stream.flush();
   }
 
-  out_stream.close();
-  in_stream.close();
+  this->write_reductions(out_stream);
+  if (this->has_walltime())
+    out_stream << this->walltime_summary(tally) << "\n";
+  if (compressed) compressed->close();
+  file_stream.close();
   return 0;
 }
 
-std::string ensemble_async_mpi::convert_argv_to_string(char* argv[]) const {
-  std::ostringstream stream;
-  for (auto p = argv; *p; ++p) stream << *p << " ";
-  return stream.str();
+std::unique_ptr<completion_journal> ensemble_async_mpi::get_journal(
+    const argh::parser& arghs, std::ostream& os) const {
+  if (!arghs["journal"]) return nullptr;
+  if (this->has_reductions())
+    throw std::invalid_argument("-journal cannot resume ensemble reductions.");
+  std::string prefix;
+  arghs("prefix", "") >> prefix;
+  return completion_journal::open_rank_journal(
+      prefix, mpi_rank_, mpi_size_, os);
+}
+
+bool ensemble_async_mpi::integrate_gyron(
+    const std::string& id, const std::string& private_options,
+    const field_box_t* field, std::ostream& os,
+    completion_journal* journal) const {
+  auto private_arghs = argh::parser(private_options + " -gyron-id=" + id);
+  auto pusher = (*pusher_builder_)(private_arghs, field);
+  double time_final;
+  private_arghs("tfinal", time_final_) >> time_final;
+  return this->integrate_gyron(
+      id, pusher.get(), private_arghs, time_final, "", os, journal);
+}
+
+bool ensemble_async_mpi::integrate_gyron(
+    const std::string& id, const gyron_ic_t& initial_condition,
+    const field_box_t* field, std::ostream& os,
+    completion_journal* journal) const {
+  auto pusher = (*pusher_builder_)(initial_condition, field);
+  return this->integrate_gyron(
+      id, pusher.get(), argh::parser("-gyron-id=" + id), time_final_,
+      gyron_ic_header(initial_condition) + "\n", os, journal);
+}
+
+bool ensemble_async_mpi::integrate_gyron(
+    const std::string& id, pusher_box_t* pusher,
+    const argh::parser& private_arghs, double time_final,
+    const std::string& preamble, std::ostream& os,
+    completion_journal* journal) const {
+  if (!journal)
+    return this->integrate_gyron(
+        pusher, private_arghs, time_final, preamble, os);
+  std::ostringstream block;
+  bool is_completed = this->integrate_gyron(
+      pusher, private_arghs, time_final, preamble, block);
+  if (is_completed) journal->commit(id, block.str());
+  os << block.str();
+  return is_completed;
 }
 
-std::pair<std::ifstream, std::ofstream> ensemble_async_mpi::get_io_streams(
-    const argh::parser& arghs, int mpi_rank) const {
+bool ensemble_async_mpi::integrate_gyron(
+    pusher_box_t* pusher, const argh::parser& private_arghs,
+    double time_final, const std::string& preamble, std::ostream& os) const {
+  os << preamble << pusher->compose_output_fields() << "\n";
+  if (argh_line_["sci-16"]) {
+    os.precision(16);
+    os.setf(std::ios::scientific);
+  }
+  auto observer = (*observer_builder_)(private_arghs, os);
+
+  bool is_interrupted = false;
+  std::string elapsed_time_info = this->integrate_orbit(
+      pusher, observer.get(), time_final, &is_interrupted);
+  if (argh_line_["elapsed-time"]) os << elapsed_time_info << "\n";
+  if (is_interrupted) os << walltime_mark_ << "\n";
+  return !is_interrupted;
+}
+
+std::ofstream ensemble_async_mpi::get_output_stream(
+    const argh::parser& arghs) const {
   std::string filename;
   arghs("prefix", "") >> filename;
-  filename += "-" + std::to_string(mpi_rank);
+  filename += "-" + std::to_string(mpi_rank_) + ".cout";
+  if (arghs("compress")) filename += ".gz";
+  std::ofstream out_stream(filename);
+  if (!out_stream.is_open())
+    throw std::runtime_error("cannot write to file " + filename + ".\n");
+  return out_stream;
+}
+
+std::vector<std::pair<std::string, std::string>>
+ensemble_async_mpi::get_option_lines(const argh::parser& arghs) const {
+  std::vector<std::pair<std::string, std::string>> option_lines;
+  std::string filename;
+  if (arghs("ensemble-file") >> filename) {
+    mpi_line_reader reader(MPI_COMM_WORLD, filename);
+    std::vector<std::string> lines = reader.read_lines();
+    size_t index = reader.first_line_index();
+    for (std::string& line : lines)
+      option_lines.emplace_back(std::to_string(index++), std::move(line));
+    return option_lines;
+  }
+  arghs("prefix", "") >> filename;
+  filename += "-" + std::to_string(mpi_rank_);
   std::ifstream in_stream(filename);
   if (!in_stream.is_open())
     throw std::runtime_error("cannot read from file " + filename + ".\n");
-  std::ofstream out_stream(filename + ".cout");
-  if (!out_stream.is_open())
-    throw std::runtime_error("cannot write to file " + filename + ".cout.\n");
-  return {std::move(in_stream), std::move(out_stream)};
+  size_t index = 0;
+  for (std::string line; std::getline(in_stream, line);)
+    option_lines.emplace_back(
+        std::to_string(mpi_rank_) + ":" + std::to_string(index++), line);
+  return option_lines;
+}
+
+void ensemble_async_mpi::write_reductions(std::ostream& os) const {
+  this->has_reductions();  // registers the entries even without gyrons.
+  for (auto& entry : reduction_registry::global().reduce()) {
+    std::span<double> data = entry->data();
+    MPI_Reduce(
+        (mpi_rank_ == 0 ? MPI_IN_PLACE : data.data()), data.data(),
+        data.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (mpi_rank_ == 0) entry->write(os);
+  }
 }
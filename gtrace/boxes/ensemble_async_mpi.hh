@@ -20,9 +20,11 @@
 #define GTRACE_ENSEMBLE_ASYNC_MPI
 
 #include <gtrace/boxes/driver_box.hh>
+#include <gtrace/tools/completion_journal.hh>
 
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 /*!
 Parallel (MPI) integration of a gyron ensemble.
@@ -40,14 +42,50 @@ corresponding input file (each one named as `prefix-nnn` with `nnn` the process
 rank number, as many input files as running processes or sub-ensembles). To save
 disk space, these input files may contain only the options particular to each
 distinct gyron, with common (or shared) options being supplied via the invoking
-command line. For each sub-ensemble, the output of the invoked puser and
-observer boxes is collected into a file named `prefix-nnn.cout`. No other
-processing is performed. To ensure that no MPI communications are needed, the
-pusher, field, and observer boxes are replicated by each process.
+command line. The shared options are parsed once and then overlaid by those
+particular to each gyron (only pusher and observer options and `-tfinal` may be
+set per gyron, the field boxes are built from the shared options alone).
+Alternatively, a single input file may be shared by all processes (option
+`-ensemble-file`): it is read collectively via MPI-IO, each process taking the
+lines starting within its own contiguous byte range, so the same file serves any
+number of processes. A binary columnar file of initial conditions (see
+`columnar_ensemble`) may be supplied instead, with each process taking a
+contiguous block of its rows. For each sub-ensemble, the output of the invoked
+puser and observer boxes is collected into a file named `prefix-nnn.cout`. The
+pusher, field, and observer boxes are replicated by each process, which then
+integrates its gyrons without communicating with the others. The only MPI
+communications are the collective reads of a shared input file (along with the
+count of the lines read by the lower ranks, see `mpi_line_reader`) and, if the
+observers accumulate reductions (see `reduction_registry`), their sum over all
+processes at the end of the run.
+
+With the option `-journal`, each process commits every finished output block to
+an append-only journal (`prefix-nnn.journal`, see `completion_journal`). A
+restarted run replays the recorded outputs into the new `prefix-nnn.cout` files
+and skips all gyrons found in any journal, even if the number of processes has
+changed (gyrons are identified by their global line number in the shared input
+file, by the pair rank:line for per-process input files, or by the id column of
+binary input).
+
+With `-locality-window=n`, each process integrates its gyrons in windows of `n`
+consecutive ones, each window sorted by the locality of their initial conditions
+(see `locality_order`), so that consecutive gyrons on the process touch nearby
+field data. The output blocks of a window are held in memory until it ends and
+then written in the ensemble order.
+
+With `-walltime` (see `driver_box_t`), each process drains on its own and ends
+its `prefix-nnn.cout` file with the summary line of its share of gyrons.
+
+With `-compress`, each process writes a gzip file `prefix-nnn.cout.gz` instead.
 
 Driver options:
 
+ + `-compress=val` Compresses the output with gzip (see `driver_box_t`).
  + `-elapsed` Prints the elapsed time for each orbit (defaults to no print).
+ + `-ensemble-binary=val` Path to a binary columnar input file (shared).
+ + `-ensemble-file=val` Path to a single input file shared by all processes.
+ + `-journal` Keeps completion journals and resumes from them.
+ + `-locality-window=val` Gyrons sorted together by locality (default none).
  + `-prefix=name` Prefix of input & output filenames.
  + `-sci-16` Turns on 16-digit scientific format for numeric output.
  + `-tfinal=val` Time-integration limit (default 1, in `pusher_box_t` units).
@@ -59,9 +97,31 @@ class ensemble_async_mpi : public driver_box_t {
   virtual int operator()(int argc, char* argv[]) const;
  private:
   int mpi_rank_, mpi_size_;
-  std::string convert_argv_to_string(char* argv[]) const;
-  std::pair<std::ifstream, std::ofstream> get_io_streams(
-      const argh::parser& arghs, int mpi_rank) const;
+  double time_final_;
+  const std::unique_ptr<pusher_builder_t> pusher_builder_;
+  std::unique_ptr<observer_builder_t> observer_builder_;
+  std::unique_ptr<completion_journal> get_journal(
+      const argh::parser& arghs, std::ostream& os) const;
+  std::ofstream get_output_stream(const argh::parser& arghs) const;
+  std::vector<std::pair<std::string, std::string>> get_option_lines(
+      const argh::parser& arghs) const;
+  bool integrate_gyron(
+      const std::string& id, const std::string& private_options,
+      const field_box_t* field, std::ostream& os,
+      completion_journal* journal) const;
+  bool integrate_gyron(
+      const std::string& id, const gyron_ic_t& initial_condition,
+      const field_box_t* field, std::ostream& os,
+      completion_journal* journal) const;
+  bool integrate_gyron(
+      const std::string& id, pusher_box_t* pusher,
+      const argh::parser& private_arghs, double time_final,
+      const std::string& preamble, std::ostream& os,
+      completion_journal* journal) const;
+  bool integrate_gyron(
+      pusher_box_t* pusher, const argh::parser& private_arghs,
+      double time_final, const std::string& preamble, std::ostream& os) const;
+  virtual void write_reductions(std::ostream& os) const override;
 };
 
 #endif  // GTRACE_ENSEMBLE_ASYNC_MPI
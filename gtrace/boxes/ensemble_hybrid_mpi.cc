@@ -0,0 +1,317 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/ensemble_hybrid_mpi.cc, this file is part of gtrace.
+
+#include <gtrace/boxes/ensemble_hybrid_mpi.hh>
+#include <gtrace/tools/columnar_ensemble.hh>
+#include <gtrace/tools/gzip_ostream.hh>
+#include <gtrace/tools/layered_arghs.hh>
+#include <gtrace/tools/locality_order.hh>
+#include <gtrace/tools/mpi_line_reader.hh>
+#include <gtrace/tools/numa_topology.hh>
+#include <gtrace/tools/reduction_registry.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <iostream>
+#include <memory>
+#include <mpi.h>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <syncstream>
+#include <thread>
+
+ensemble_hybrid_mpi::ensemble_hybrid_mpi(int argc, char* argv[])
+    : driver_box_t(argc, argv),
+      pusher_builder_(create_linked_pusher_builder(argh_line_)) {
+  argh_line_("tfinal", 1) >> time_final_;
+  argh_line_("cost-probe", 0) >> cost_probe_;
+  std::string cost_filename;
+  if (argh_line_("cost-file") >> cost_filename)
+    cost_table_ = std::make_unique<cost_table>(cost_filename);
+  int thread_support;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_support);
+  if (thread_support < MPI_THREAD_FUNNELED) {
+    std::cerr << "gtrace: the mpi library does not support threads.\n";
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+  MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank_);
+  MPI_Comm_size(MPI_COMM_WORLD, &mpi_size_);
+  observer_builder_ = create_linked_observer_builder(layered_arghs(
+      argh_line_, argh::parser("-mpi-rank=" + std::to_string(mpi_rank_))));
+}
+
+ensemble_hybrid_mpi::~ensemble_hybrid_mpi() { MPI_Finalize(); }
+
+int ensemble_hybrid_mpi::operator()(int argc, char* argv[]) const {
+  std::ofstream file_stream = this->get_output_stream(argh_line_);
+  auto compressed = this->get_compressed_stream(file_stream);
+  std::ostream& out_stream =
+      (compressed ? *compressed : static_cast<std::ostream&>(file_stream));
+  out_stream << this->header_string(argc, argv) << "\n";
+  auto journal = this->get_journal(argh_line_, out_stream);
+  std::string binary_filename;
+  auto ensemble = (argh_line_("ensemble-binary") >> binary_filename
+                       ? std::make_unique<columnar_ensemble>(binary_filename)
+                       : nullptr);
+  std::vector<std::pair<std::string, std::string>> option_lines;
+  if (!ensemble) option_lines = this->get_option_lines(argh_line_);
+  size_t begin = 0, end = option_lines.size();
+  if (ensemble) {
+    begin = ensemble->size() * mpi_rank_ / mpi_size_;
+    end = ensemble->size() * (mpi_rank_ + 1) / mpi_size_;
+  }
+
+  size_t n_threads = std::max(1u, std::thread::hardware_concurrency());
+  argh_line_("threads", n_threads) >> n_threads;
+  auto topology =
+      (argh_line_["numa"] ? std::make_unique<numa_topology>() : nullptr);
+  std::unique_ptr<field_box_t> shared_field =
+      create_linked_field_box(argh_line_);
+  bool is_field_per_thread =
+      (argh_line_["field-per-thread"] || !shared_field->is_thread_safe());
+  bool is_field_per_domain = (topology && !is_field_per_thread);
+  if (topology) shared_field.reset();
+  std::vector<std::unique_ptr<field_box_t>> domain_fields(
+      is_field_per_domain ? topology->size() : 0);
+  std::vector<std::once_flag> domain_flags(domain_fields.size());
+  std::ofstream cost_stream = this->get_cost_stream(argh_line_);
+
+  auto visit_gyron = [&](size_t i, const auto& action) {
+    if (ensemble)
+      action(std::to_string((uint64_t)(*ensemble)[i].id), (*ensemble)[i]);
+    else action(option_lines[i].first, option_lines[i].second);
+  };
+  std::vector<size_t> order(end - begin);
+  std::iota(order.begin(), order.end(), begin);
+  bool is_cost_ordered = (cost_table_ || cost_probe_ > 0);
+  size_t window;
+  argh_line_("locality-window", 0) >> window;
+  if (!is_cost_ordered && window > 1)
+    for (size_t first = 0; first < order.size(); first += window) {
+      size_t last = std::min(first + window, order.size());
+      std::vector<gyron_ic_t> initial_conditions;
+      for (size_t k = first; k < last; k++)
+        visit_gyron(order[k], [&](const std::string&, const auto& input) {
+          initial_conditions.push_back(
+              pusher_builder_->initial_condition(input));
+        });
+      std::vector<size_t> window_order = locality_order(initial_conditions);
+      for (size_t& k : window_order) k = order[first + k];
+      std::copy(
+          window_order.begin(), window_order.end(), order.begin() + first);
+    }
+  std::vector<double> costs(is_cost_ordered ? order.size() : 0, 0);
+  std::barrier sync_point(n_threads, [&]() noexcept {
+    if (!is_cost_ordered) return;
+    std::vector<size_t> cost_order = longest_first_order(costs);
+    for (size_t& i : cost_order) i = order[i];
+    order = std::move(cost_order);
+  });
+
+  std::atomic<size_t> next_probe = 0, next_line = 0;
+  walltime_tally_t tally;
+  std::once_flag drain_flush;
+  auto worker = [&](size_t i) {
+    size_t domain = (topology ? topology->domain_of(i) : 0);
+    if (topology) topology->bind_thread(domain);
+    std::unique_ptr<field_box_t> own_field =
+        (is_field_per_thread && (i > 0 || !shared_field)
+             ? create_linked_field_box(argh_line_)
+             : nullptr);
+    if (is_field_per_domain)
+      std::call_once(domain_flags[domain], [&]() {
+        domain_fields[domain] = create_linked_field_box(argh_line_);
+      });
+    const field_box_t* field =
+        (own_field             ? own_field.get()
+         : is_field_per_domain ? domain_fields[domain].get()
+                               : shared_field.get());
+    auto predict = [&](size_t k) {
+      return [&, k](const std::string& id, const auto& input) {
+        if (journal && journal->is_completed(id)) return;
+        if (this->is_draining()) return;
+        auto recorded_cost = (cost_table_ ? (*cost_table_)(id) : std::nullopt);
+        if (recorded_cost) costs[k] = *recorded_cost;
+        else if (cost_probe_ > 0) costs[k] = this->probe_cost(input, field);
+      };
+    };
+    auto integrate = [&](const std::string& id, const auto& input) {
+      if (journal && journal->is_completed(id)) return;
+      if (this->is_draining()) {
+        tally.not_started++;
+        std::call_once(drain_flush, [&]() {
+          std::osyncstream(out_stream) << std::flush_emit;
+        });
+        return;
+      }
+      std::ostringstream block;
+      double cost;
+      bool is_completed = this->integrate_gyron(id, input, field, block, cost);
+      (is_completed ? tally.completed : tally.interrupted)++;
+      if (journal && is_completed) journal->commit(id, block.str());
+      std::osyncstream(out_stream) << block.str();
+      if (is_completed && cost_stream.is_open())
+        std::osyncstream(cost_stream) << id << " " << cost << "\n";
+    };
+    if (is_cost_ordered)
+      for (size_t k = next_probe++; k < order.size(); k = next_probe++)
+        visit_gyron(order[k], predict(k));
+    sync_point.arrive_and_wait();
+    for (size_t k = next_line++; k < order.size(); k = next_line++)
+      visit_gyron(order[k], integrate);
+  };
+  {
+    std::vector<std::jthread> pool;
+    for (size_t i = 0; i < n_threads; i++) pool.emplace_back(worker, i);
+  }
+
+  this->write_reductions(out_stream);
+  if (this->has_walltime())
+    out_stream << this->walltime_summary(tally) << "\n";
+  if (compressed) compressed->close();
+  file_stream.close();
+  return 0;
+}
+
+std::ofstream ensemble_hybrid_mpi::get_cost_stream(
+    const argh::parser& arghs) const {
+  std::string filename;
+  if (!(arghs("cost-output") >> filename)) return std::ofstream();
+  filename += "-" + std::to_string(mpi_rank_);
+  std::ofstream cost_stream(filename, std::ios::app);
+  if (!cost_stream.is_open())
+    throw std::runtime_error("cannot write to file " + filename + ".\n");
+  return cost_stream;
+}
+
+std::ofstream ensemble_hybrid_mpi::get_output_stream(
+    const argh::parser& arghs) const {
+  std::string filename;
+  arghs("prefix", "") >> filename;
+  filename += "-" + std::to_string(mpi_rank_) + ".cout";
+  if (arghs("compress")) filename += ".gz";
+  std::ofstream out_stream(filename);
+  if (!out_stream.is_open())
+    throw std::runtime_error("cannot write to file " + filename + ".\n");
+  return out_stream;
+}
+
+std::unique_ptr<completion_journal> ensemble_hybrid_mpi::get_journal(
+    const argh::parser& arghs, std::ostream& os) const {
+  if (!arghs["journal"]) return nullptr;
+  if (this->has_reductions())
+    throw std::invalid_argument("-journal cannot resume ensemble reductions.");
+  std::string prefix;
+  arghs("prefix", "") >> prefix;
+  return completion_journal::open_rank_journal(
+      prefix, mpi_rank_, mpi_size_, os);
+}
+
+std::vector<std::pair<std::string, std::string>>
+ensemble_hybrid_mpi::get_option_lines(const argh::parser& arghs) const {
+  std::vector<std::pair<std::string, std::string>> option_lines;
+  std::string filename;
+  if (arghs("ensemble-file") >> filename) {
+    mpi_line_reader reader(MPI_COMM_WORLD, filename);
+    std::vector<std::string> lines = reader.read_lines();
+    size_t index = reader.first_line_index();
+    for (std::string& line : lines)
+      option_lines.emplace_back(std::to_string(index++), std::move(line));
+    return option_lines;
+  }
+  arghs("prefix", "") >> filename;
+  filename += "-" + std::to_string(mpi_rank_);
+  std::ifstream in_stream(filename);
+  if (!in_stream.is_open())
+    throw std::runtime_error("cannot read from file " + filename + ".\n");
+  size_t index = 0;
+  for (std::string line; std::getline(in_stream, line);)
+    option_lines.emplace_back(
+        std::to_string(mpi_rank_) + ":" + std::to_string(index++), line);
+  return option_lines;
+}
+
+bool ensemble_hybrid_mpi::integrate_gyron(
+    const std::string& id, const std::string& private_options,
+    const field_box_t* field, std::ostream& os, double& cost) const {
+  auto private_arghs = argh::parser(private_options + " -gyron-id=" + id);
+  auto pusher = (*pusher_builder_)(private_arghs, field);
+  double time_final;
+  private_arghs("tfinal", time_final_) >> time_final;
+  return this->integrate_gyron(
+      pusher.get(), private_arghs, time_final, os, cost);
+}
+
+bool ensemble_hybrid_mpi::integrate_gyron(
+    const std::string& id, const gyron_ic_t& initial_condition,
+    const field_box_t* field, std::ostream& os, double& cost) const {
+  auto pusher = (*pusher_builder_)(initial_condition, field);
+  os << gyron_ic_header(initial_condition) << "\n";
+  return this->integrate_gyron(
+      pusher.get(), argh::parser("-gyron-id=" + id), time_final_, os, cost);
+}
+
+bool ensemble_hybrid_mpi::integrate_gyron(
+    pusher_box_t* pusher, const argh::parser& private_arghs, double time_final,
+    std::ostream& os, double& cost) const {
+  os << pusher->compose_output_fields() << "\n";
+  if (argh_line_["sci-16"]) {
+    os.precision(16);
+    os.setf(std::ios::scientific);
+  }
+  auto observer = (*observer_builder_)(private_arghs, os);
+
+  bool is_interrupted = false;
+  std::string elapsed_time_info = this->integrate_orbit(
+      pusher, observer.get(), time_final, &is_interrupted, &cost);
+  if (argh_line_["elapsed-time"]) os << elapsed_time_info << "\n";
+  if (is_interrupted) os << walltime_mark_ << "\n";
+  return !is_interrupted;
+}
+
+double ensemble_hybrid_mpi::probe_cost(
+    const std::string& private_options, const field_box_t* field) const {
+  auto private_arghs = argh::parser(private_options);
+  auto pusher = (*pusher_builder_)(private_arghs, field);
+  double time_final;
+  private_arghs("tfinal", time_final_) >> time_final;
+  return this->probe_orbit_cost(
+      pusher.get(), time_final, cost_probe_, *observer_builder_,
+      private_arghs);
+}
+
+double ensemble_hybrid_mpi::probe_cost(
+    const gyron_ic_t& initial_condition, const field_box_t* field) const {
+  auto pusher = (*pusher_builder_)(initial_condition, field);
+  return this->probe_orbit_cost(
+      pusher.get(), time_final_, cost_probe_, *observer_builder_,
+      argh::parser());
+}
+
+void ensemble_hybrid_mpi::write_reductions(std::ostream& os) const {
+  this->has_reductions();  // registers the entries even without gyrons.
+  for (auto& entry : reduction_registry::global().reduce()) {
+    std::span<double> data = entry->data();
+    MPI_Reduce(
+        (mpi_rank_ == 0 ? MPI_IN_PLACE : data.data()), data.data(),
+        data.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (mpi_rank_ == 0) entry->write(os);
+  }
+}
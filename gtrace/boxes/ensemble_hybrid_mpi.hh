@@ -0,0 +1,135 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/ensemble_hybrid_mpi.hh, this file is part of gtrace.
+
+#ifndef GTRACE_ENSEMBLE_HYBRID_MPI
+#define GTRACE_ENSEMBLE_HYBRID_MPI
+
+#include <gtrace/boxes/driver_box.hh>
+#include <gtrace/tools/completion_journal.hh>
+#include <gtrace/tools/cost_table.hh>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*!
+Hybrid (MPI + threads) integration of a gyron ensemble.
+-------------------------------------------------------
+
+Splits the ensemble by a number of mpi processes, as `ensemble_async_mpi` does,
+but each process runs a pool of threads that integrate its sub-ensemble in
+parallel. The intended layout is one mpi process per node (or per numa domain,
+eg via `mpirun --map-by numa`), with as many threads as cores therein. Within
+each process, a single `field_box_t` object is built from the shared options
+and used by all threads, so the field memory and setup cost are paid once per
+process instead of once per core.
+
+Each process reads the options particular to each gyron from the lines of its
+own input file (named `prefix-nnn`, with `nnn` the process rank) or, if the
+option `-ensemble-file` is set, from its share of a single input file read
+collectively via MPI-IO (as in `ensemble_async_mpi`). A binary columnar file
+(see `columnar_ensemble`) may be supplied instead, each process taking a
+contiguous block of its rows. Threads pick the gyrons dynamically, one at a
+time. As in `ensemble_async_mpi`, the shared options are parsed once and then
+overlaid by the pusher and observer options (and `-tfinal`) particular to each
+gyron. The output of each gyron is collected as a whole and then appended to the
+file `prefix-nnn.cout`, thus blocks from different gyrons never interleave
+(their order, though, depends on the completion time). The option `-journal`
+keeps per-process completion journals and resumes from them, exactly as in
+`ensemble_async_mpi`.
+
+Costs may be predicted as in `ensemble_async` (by `-cost-file` and/or
+`-cost-probe`, the probes being shared by the threads of each process), in which
+case each process starts its gyrons in decreasing order of cost. Otherwise, with
+`-locality-window=n`, each process starts its gyrons in windows of `n`
+consecutive ones, each window sorted by the locality of their initial conditions
+(see `locality_order`), so that the gyrons running together on a process touch
+nearby field data. With `-cost-output=name`, each process appends the measured
+costs to `name-nnn`, all of which are read back by `-cost-file=name` (see
+`cost_table`). Probes run on the worker threads before they start integrating,
+and the recorded costs time the orbit integration alone.
+
+With `-numa`, the threads of each process are pinned round-robin to the NUMA
+domains left to it by the launcher (see `numa_topology`). A read-only replica of
+the field box is then built on each domain by the first thread pinned to it (so
+that its data is first touched, and thus allocated, on that domain's node), and
+every thread reads only the replica local to its domain. Combined with
+`-field-per-thread`, each pinned thread builds its own field box instead. Field
+boxes not safe to be read concurrently (see `field_box_t`, eg `vmec_b -cached`)
+always get one box per thread, as with `-field-per-thread`. The mpi library must
+support at least `MPI_THREAD_FUNNELED`, otherwise the run is aborted.
+
+With `-walltime` (see `driver_box_t`), each process drains on its own and ends
+its `prefix-nnn.cout` file with the summary line of its share of gyrons.
+
+With `-compress`, each process writes a gzip file `prefix-nnn.cout.gz` instead.
+
+Driver options:
+
+ + `-compress=val` Compresses the output with gzip (see `driver_box_t`).
+ + `-cost-file=val` Costs recorded by a previous run (see `cost_table`).
+ + `-cost-output=val` Prefix of the files recording the cost of each gyron.
+ + `-cost-probe=val` Fraction of `tfinal` integrated to predict costs.
+ + `-elapsed-time` Prints the elapsed time for each orbit (default no print).
+ + `-ensemble-binary=val` Path to a binary columnar input file (shared).
+ + `-ensemble-file=val` Path to a single input file shared by all processes.
+ + `-field-per-thread`\
+    Builds one `field_box_t` per thread instead of sharing a single one
+    (implied by field boxes not safe to be read concurrently).
+ + `-journal` Keeps completion journals and resumes from them.
+ + `-locality-window=val` Gyrons sorted together by locality (default none).
+ + `-numa` Pins the worker threads to NUMA domains (see `numa_topology`).
+ + `-prefix=name` Prefix of input & output filenames.
+ + `-sci-16` Turns on 16-digit scientific format for numeric output.
+ + `-tfinal=val` Time-integration limit (default 1, in `pusher_box_t` units).
+ + `-threads=val` Threads per process (defaults to the number of cores).
+!*/
+class ensemble_hybrid_mpi : public driver_box_t {
+ public:
+  ensemble_hybrid_mpi(int argc, char* argv[]);
+  virtual ~ensemble_hybrid_mpi();
+  virtual int operator()(int argc, char* argv[]) const;
+ private:
+  int mpi_rank_, mpi_size_;
+  double time_final_, cost_probe_;
+  const std::unique_ptr<pusher_builder_t> pusher_builder_;
+  std::unique_ptr<observer_builder_t> observer_builder_;
+  std::unique_ptr<cost_table> cost_table_;
+  std::ofstream get_cost_stream(const argh::parser& arghs) const;
+  std::unique_ptr<completion_journal> get_journal(
+      const argh::parser& arghs, std::ostream& os) const;
+  std::ofstream get_output_stream(const argh::parser& arghs) const;
+  std::vector<std::pair<std::string, std::string>> get_option_lines(
+      const argh::parser& arghs) const;
+  bool integrate_gyron(
+      const std::string& id, const std::string& private_options,
+      const field_box_t* field, std::ostream& os, double& cost) const;
+  bool integrate_gyron(
+      const std::string& id, const gyron_ic_t& initial_condition,
+      const field_box_t* field, std::ostream& os, double& cost) const;
+  bool integrate_gyron(
+      pusher_box_t* pusher, const argh::parser& private_arghs,
+      double time_final, std::ostream& os, double& cost) const;
+  double probe_cost(
+      const std::string& private_options, const field_box_t* field) const;
+  double probe_cost(
+      const gyron_ic_t& initial_condition, const field_box_t* field) const;
+  virtual void write_reductions(std::ostream& os) const override;
+};
+
+#endif  // GTRACE_ENSEMBLE_HYBRID_MPI
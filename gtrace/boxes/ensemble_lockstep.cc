@@ -0,0 +1,307 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/ensemble_lockstep.cc, this file is part of gtrace.
+
+#include <gtrace/boxes/ensemble_lockstep.hh>
+#include <gtrace/tools/gzip_ostream.hh>
+#include <gtrace/tools/locality_order.hh>
+#include <gtrace/tools/numa_topology.hh>
+#include <gtrace/tools/reorder_buffer.hh>
+#include <gtrace/tools/text_record.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+#include <unistd.h>
+
+ensemble_lockstep::ensemble_lockstep(int argc, char* argv[])
+    : driver_box_t(argc, argv),
+      pusher_builder_(create_linked_pusher_builder(argh_line_)),
+      observer_builder_(create_linked_observer_builder(argh_line_)) {
+  argh_line_("tfinal", 1) >> time_final_;
+  argh_line_("tile-size", 64) >> tile_size_;
+  tile_size_ = std::max<size_t>(tile_size_, 1);
+  argh_line_("locality-window", 0) >> window_;
+}
+
+ensemble_lockstep::ensemble_reader_t::ensemble_reader_t(
+    const argh::parser& arghs) {
+  std::string filename;
+  if (arghs("ensemble-binary") >> filename) {
+    binary_ = std::make_unique<columnar_ensemble>(filename);
+    return;
+  }
+  arghs("ensemble-file", "") >> filename;
+  text_.open(filename);
+  if (!text_.is_open())
+    throw std::runtime_error("cannot read from file " + filename + ".\n");
+}
+
+std::optional<ensemble_lockstep::gyron_input_t>
+ensemble_lockstep::ensemble_reader_t::next() {
+  if (binary_) {
+    if (next_ == binary_->size()) return std::nullopt;
+    return (*binary_)[next_++];
+  }
+  std::string line;
+  if (!std::getline(text_, line)) return std::nullopt;
+  return line;
+}
+
+void ensemble_lockstep::read_tiles(
+    ensemble_reader_t& reader, size_t& next_index,
+    std::deque<tile_t>& tiles) const {
+  std::vector<gyron_input_t> inputs;
+  for (size_t n = (window_ < 2 ? tile_size_ : window_); inputs.size() < n;) {
+    auto input = reader.next();
+    if (!input) break;
+    inputs.push_back(std::move(*input));
+  }
+  std::vector<size_t> order(inputs.size());
+  std::iota(order.begin(), order.end(), 0);
+  if (window_ > 1) {
+    std::vector<gyron_ic_t> initial_conditions;
+    for (const gyron_input_t& input : inputs)
+      initial_conditions.push_back(std::visit(
+          [&](const auto& gyron) {
+            return pusher_builder_->initial_condition(gyron);
+          },
+          input));
+    order = locality_order(initial_conditions);
+  }
+  for (size_t begin = 0; begin < order.size(); begin += tile_size_) {
+    size_t end = std::min(begin + tile_size_, order.size());
+    tile_t tile;
+    for (size_t i = begin; i < end; i++) {
+      tile.indices.push_back(next_index + order[i]);
+      tile.inputs.push_back(std::move(inputs[order[i]]));
+    }
+    tiles.push_back(std::move(tile));
+  }
+  next_index += inputs.size();
+}
+
+std::vector<std::string> ensemble_lockstep::integrate_tile(
+    const tile_t& tile, const field_box_t* field, walltime_tally_t& tally,
+    std::vector<slice_t>* slices) const {
+  std::vector<gyron_t> gyrons;
+  for (size_t i = 0; i < tile.inputs.size(); i++)
+    gyrons.push_back(std::visit(
+        [&](const auto& gyron) {
+          return this->setup_gyron(gyron, tile.indices[i], field);
+        },
+        tile.inputs[i]));
+  std::vector<gyron_t*> active;
+  for (gyron_t& gyron : gyrons) active.push_back(&gyron);
+  bool is_peek_beyond = argh_line_["peek-beyond-tfinal"];
+  auto is_retired = [&](gyron_t* g) {
+    if ((*g->observer)(g->pusher.get(), g->time) && g->time <= time_final_)
+      return false;
+    if (is_peek_beyond) (*g->observer)(g->pusher.get(), g->time);
+    g->observer->flush();
+    g->pusher.reset();
+    return true;
+  };
+  for (size_t step = 0; !active.empty(); step++) {
+    std::erase_if(active, is_retired);
+    if (active.empty()) break;
+    if (step % walltime_check_steps_ == 0 && this->is_out_of_time()) break;
+    if (slices) {
+      if (slices->size() <= step) slices->resize(step + 1);
+      this->accumulate_slice(active, field, (*slices)[step]);
+    }
+    double time = active.front()->time;
+    for (gyron_t* g : active) g->time = g->pusher->push_state(g->time);
+    for (gyron_t* g : active)
+      if (g->time != active.front()->time || !(g->time > time))
+        throw std::runtime_error("gyrons out of the shared time grid.");
+  }
+  for (gyron_t* g : active) {
+    g->observer->flush();
+    *g->out_stream << walltime_mark_ << "\n";
+  }
+  tally.completed += gyrons.size() - active.size();
+  tally.interrupted += active.size();
+  std::vector<std::string> blocks;
+  for (const gyron_t& gyron : gyrons) blocks.push_back(gyron.out_stream->str());
+  return blocks;
+}
+
+void ensemble_lockstep::accumulate_slice(
+    std::span<gyron_t* const> active, const field_box_t* field,
+    slice_t& slice) const {
+  double time = active.front()->time;
+  std::vector<IR3> positions;
+  for (const gyron_t* g : active) positions.push_back(g->pusher->get_q(time));
+  std::vector<double> magnitudes(positions.size());
+  field->magnetic_magnitudes(positions, time, magnitudes);
+  slice.time = time;
+  for (size_t i = 0; i < active.size(); i++) {
+    double weight = active[i]->pusher->get_weight();
+    slice.weight += weight;
+    slice.sum += weight * magnitudes[i];
+    slice.sum_squares += weight * magnitudes[i] * magnitudes[i];
+  }
+}
+
+void ensemble_lockstep::write_slices(
+    const std::vector<slice_t>& slices, std::ostream& os) const {
+  os << "# slices: t weight B_mean B_std\n";
+  for (const slice_t& slice : slices) {
+    if (slice.weight == 0) continue;
+    double mean = slice.sum / slice.weight;
+    double variance = slice.sum_squares / slice.weight - mean * mean;
+    double deviation = std::sqrt(std::max(variance, 0.0));
+    text_record::write(os, {slice.time, slice.weight, mean, deviation});
+  }
+}
+
+int ensemble_lockstep::operator()(int argc, char* argv[]) const {
+  auto compressed = this->get_compressed_stream(std::cout);
+  std::ostream& result_stream = (compressed ? *compressed : std::cout);
+  result_stream << this->header_string(argc, argv) << "\n";
+  ensemble_reader_t reader(argh_line_);
+  size_t n_threads = std::max(1u, std::thread::hardware_concurrency());
+  argh_line_("threads", n_threads) >> n_threads;
+  size_t reorder_memory;
+  argh_line_("reorder-memory", 1024) >> reorder_memory;
+  std::string spill_filename;
+  argh_line_(
+      "reorder-spill", (std::filesystem::temp_directory_path() /
+                        ("gtrace-" + std::to_string(getpid()) + ".spill"))
+                           .string()) >>
+      spill_filename;
+  bool is_slice_stats = argh_line_["slice-stats"];
+
+  std::mutex input_mutex, output_mutex;
+  std::once_flag drain_flush;
+  std::exception_ptr worker_error;
+  std::atomic<bool> is_failed = false;
+  std::deque<tile_t> pending_tiles;
+  size_t next_index = 0;
+  auto next_tile = [&]() -> std::optional<tile_t> {
+    std::lock_guard<std::mutex> lock(input_mutex);
+    if (is_failed) return std::nullopt;
+    if (pending_tiles.empty())
+      this->read_tiles(reader, next_index, pending_tiles);
+    if (pending_tiles.empty()) return std::nullopt;
+    tile_t tile = std::move(pending_tiles.front());
+    pending_tiles.pop_front();
+    return tile;
+  };
+  reorder_buffer pending_blocks(reorder_memory << 20, spill_filename);
+  std::vector<slice_t> slices;
+  walltime_tally_t tally;
+  auto topology =
+      (argh_line_["numa"] ? std::make_unique<numa_topology>() : nullptr);
+  auto work = [&](size_t i) {
+    if (topology) topology->bind_thread(topology->domain_of(i));
+    auto field = create_linked_field_box(argh_line_);
+    std::vector<slice_t> worker_slices;
+    while (auto tile = next_tile()) {
+      std::vector<std::string> tile_blocks(tile->indices.size());
+      if (this->is_draining()) tally.not_started += tile->indices.size();
+      else
+        tile_blocks = this->integrate_tile(
+            *tile, field.get(), tally,
+            (is_slice_stats ? &worker_slices : nullptr));
+      std::lock_guard<std::mutex> lock(output_mutex);
+      for (size_t i = 0; i < tile->indices.size(); i++)
+        pending_blocks.put(tile->indices[i], std::move(tile_blocks[i]));
+      pending_blocks.release(
+          [&](const std::string& block) { result_stream << block; });
+      if (this->is_draining())
+        std::call_once(drain_flush, [&]() { result_stream.flush(); });
+    }
+    std::lock_guard<std::mutex> lock(output_mutex);
+    if (slices.size() < worker_slices.size())
+      slices.resize(worker_slices.size());
+    for (size_t step = 0; step < worker_slices.size(); step++) {
+      const slice_t& slice = worker_slices[step];
+      if (slice.weight == 0) continue;
+      slices[step].time = slice.time;
+      slices[step].weight += slice.weight;
+      slices[step].sum += slice.sum;
+      slices[step].sum_squares += slice.sum_squares;
+    }
+  };
+  auto worker = [&](size_t i) {
+    try {
+      work(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(input_mutex);
+      if (!worker_error) worker_error = std::current_exception();
+      is_failed = true;
+    }
+  };
+  {
+    std::vector<std::jthread> workers;
+    for (size_t i = 0; i < n_threads; i++) workers.emplace_back(worker, i);
+  }
+  if (worker_error) std::rethrow_exception(worker_error);
+  this->write_reductions(result_stream);
+  if (is_slice_stats) this->write_slices(slices, result_stream);
+  if (this->has_walltime())
+    result_stream << this->walltime_summary(tally) << "\n";
+  result_stream.flush();
+  if (compressed) compressed->close();
+  return 0;
+}
+
+ensemble_lockstep::gyron_t ensemble_lockstep::setup_gyron(
+    const std::string& private_options, size_t index,
+    const field_box_t* field) const {
+  auto private_arghs = argh::parser(
+      private_options + " -gyron-id=" + std::to_string(index));
+  if (private_arghs("tfinal") || private_arghs("samples"))
+    throw std::invalid_argument(
+        "private -tfinal or -samples break the shared time grid.");
+  return this->setup_gyron(
+      (*pusher_builder_)(private_arghs, field), private_arghs, "");
+}
+
+ensemble_lockstep::gyron_t ensemble_lockstep::setup_gyron(
+    const gyron_ic_t& initial_condition, size_t,
+    const field_box_t* field) const {
+  std::string id = std::to_string((uint64_t)initial_condition.id);
+  return this->setup_gyron(
+      (*pusher_builder_)(initial_condition, field),
+      argh::parser("-gyron-id=" + id),
+      gyron_ic_header(initial_condition) + "\n");
+}
+
+ensemble_lockstep::gyron_t ensemble_lockstep::setup_gyron(
+    std::unique_ptr<pusher_box_t>&& pusher,
+    const argh::parser& private_arghs, const std::string& preamble) const {
+  auto out_stream = std::make_unique<std::ostringstream>();
+  *out_stream << preamble << pusher->compose_output_fields() << "\n";
+  if (argh_line_["sci-16"]) {
+    out_stream->precision(16);
+    out_stream->setf(std::ios::scientific);
+  }
+  auto observer = (*observer_builder_)(private_arghs, *out_stream);
+  return {
+      .out_stream = std::move(out_stream), .pusher = std::move(pusher),
+      .observer = std::move(observer), .time = 0};
+}
@@ -0,0 +1,153 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/ensemble_lockstep.hh, this file is part of gtrace.
+
+#ifndef GTRACE_ENSEMBLE_LOCKSTEP
+#define GTRACE_ENSEMBLE_LOCKSTEP
+
+#include <gtrace/boxes/driver_box.hh>
+#include <gtrace/tools/columnar_ensemble.hh>
+
+#include <deque>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+/*!
+Time-synchronous (lockstep) integration of a gyron ensemble.
+------------------------------------------------------------
+
+Splits the ensemble into tiles of `-tile-size` gyrons and advances all gyrons in
+a tile together over a shared time grid, one time step at a time, instead of
+integrating each orbit to completion before starting the next one. Consecutive
+pushes within a tile thus evaluate the field at the positions of the whole tile,
+sharing the field data (eg, spline tables) brought into cache by their
+neighbours. Each pusher still evaluates the field one gyron at a time, within
+gyronimo's equations of motion, which take no batches of positions: only the
+slice statistics below query the field box in batches. A gyron is retired from
+the tile as soon as its observer stops it or its time exceeds `-tfinal`, so the
+remaining ones are kept contiguous. Each gyron performs exactly the same
+sequence of pushes and observer calls as in the other drivers, thus the results
+are unchanged. The time grid (`-tfinal` and the pusher's `-samples`) is shared
+by the whole ensemble: private values of either option are rejected, and a tile
+whose gyrons fall out of step stops the run (the first error raised by any
+worker stops the others from taking more tiles and is rethrown once all of them
+are joined).
+
+With `-slice-stats`, each time slice of a tile (ie, the positions of all its
+active gyrons at the same time) is handed in one batch to the field box's
+`magnetic_magnitudes()` (see `field_box_t`), and the weighted mean and standard
+deviation of $|B|$ over the ensemble are accumulated per slice and printed after
+the reductions, as `# slices: t weight B_mean B_std` followed by one line per
+slice.
+
+The ensemble is read either from a text file with one set of private options per
+line (overlaying the shared ones, as in `ensemble_async`) or from a binary
+columnar file (see `columnar_ensemble`). Workers pull tiles from the input as
+they go, so the ensemble is never held in memory as a whole, and each worker has
+its own field box. With `-locality-window=n`, the gyrons in each window of `n`
+consecutive ones are sorted by the locality of their initial conditions (see
+`locality_order`) before being split into tiles, so each tile gathers gyrons
+starting close to each other. Output blocks are sent to `std::cout` in the
+ensemble order, through a `reorder_buffer` holding at most `-reorder-memory`
+MiB, past which the blocks needed last are spilled to the file `-reorder-spill`
+(removed at the end), so a slow tile never makes the memory grow with the
+ensemble.
+
+With `-numa`, the workers are pinned round-robin to the NUMA domains of the
+process (see `numa_topology`) before building their own field boxes, which thus
+live in the memory local to each worker.
+
+With `-walltime` (see `driver_box_t`), workers take no more tiles once the run
+starts draining, and the gyrons still active in a tile are interrupted together;
+the summary line is printed last to `std::cout`.
+
+Driver options:
+
+ + `-compress=val` Compresses the output with gzip (see `driver_box_t`).
+ + `-ensemble-binary=val` Path to a binary columnar input file.
+ + `-ensemble-file=val` Path to the input file, one set of options per line.
+ + `-locality-window=val` Gyrons sorted together by locality (default none).
+ + `-numa` Pins the worker threads to NUMA domains (see `numa_topology`).
+ + `-reorder-memory=val` Memory of the reorder buffer in MiB (default 1024).
+ + `-reorder-spill=val` Spill file of the reorder buffer (default in `/tmp`).
+ + `-sci-16` Turns on 16-digit scientific format for numeric output.
+ + `-slice-stats` Accumulates $|B|$ statistics per time slice (see above).
+ + `-tfinal=val` Time-integration limit (default 1, in `pusher_box_t` units).
+ + `-threads=val` Number of worker threads (defaults to the number of cores).
+ + `-tile-size=val` Number of gyrons advanced together (default 64).
+!*/
+class ensemble_lockstep : public driver_box_t {
+ public:
+  ensemble_lockstep(int argc, char* argv[]);
+  virtual ~ensemble_lockstep() {};
+  virtual int operator()(int argc, char* argv[]) const;
+ private:
+  using gyron_input_t = std::variant<std::string, gyron_ic_t>;
+  struct gyron_t {
+    std::unique_ptr<std::ostringstream> out_stream;
+    std::unique_ptr<pusher_box_t> pusher;
+    std::unique_ptr<observer_box_t> observer;
+    double time;
+  };
+  struct tile_t {
+    std::vector<size_t> indices;
+    std::vector<gyron_input_t> inputs;
+  };
+  struct slice_t {
+    double time = 0, weight = 0, sum = 0, sum_squares = 0;
+  };
+  class ensemble_reader_t {
+   public:
+    ensemble_reader_t(const argh::parser& arghs);
+    std::optional<gyron_input_t> next();
+   private:
+    std::unique_ptr<columnar_ensemble> binary_;
+    std::ifstream text_;
+    size_t next_ = 0;
+  };
+  double time_final_;
+  size_t tile_size_, window_;
+  const std::unique_ptr<pusher_builder_t> pusher_builder_;
+  const std::unique_ptr<observer_builder_t> observer_builder_;
+  std::vector<std::string> integrate_tile(
+      const tile_t& tile, const field_box_t* field, walltime_tally_t& tally,
+      std::vector<slice_t>* slices) const;
+  void read_tiles(
+      ensemble_reader_t& reader, size_t& next_index,
+      std::deque<tile_t>& tiles) const;
+  void accumulate_slice(
+      std::span<gyron_t* const> active, const field_box_t* field,
+      slice_t& slice) const;
+  void write_slices(
+      const std::vector<slice_t>& slices, std::ostream& os) const;
+  gyron_t setup_gyron(
+      const std::string& private_options, size_t index,
+      const field_box_t* field) const;
+  gyron_t setup_gyron(
+      const gyron_ic_t& initial_condition, size_t index,
+      const field_box_t* field) const;
+  gyron_t setup_gyron(
+      std::unique_ptr<pusher_box_t>&& pusher,
+      const argh::parser& private_arghs, const std::string& preamble) const;
+};
+
+#endif  // GTRACE_ENSEMBLE_LOCKSTEP
@@ -0,0 +1,188 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/ensemble_server.cc, this file is part of gtrace.
+
+#include <gtrace/boxes/ensemble_server.hh>
+#include <gtrace/tools/numa_topology.hh>
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+ensemble_server::ensemble_server(int argc, char* argv[])
+    : driver_box_t(argc, argv),
+      pusher_builder_(create_linked_pusher_builder(argh_line_)),
+      observer_builder_(create_linked_observer_builder(argh_line_)) {
+  argh_line_("tfinal", 1) >> time_final_;
+}
+
+std::string ensemble_server::integrate_gyron(
+    const std::string& private_options, const field_box_t* field) const {
+  auto private_arghs = argh::parser(private_options);
+  auto pusher = (*pusher_builder_)(private_arghs, field);
+  double time_final;
+  private_arghs("tfinal", time_final_) >> time_final;
+  std::ostringstream out_stream;
+  out_stream << pusher->compose_output_fields() << "\n";
+  if (argh_line_["sci-16"]) {
+    out_stream.precision(16);
+    out_stream.setf(std::ios::scientific);
+  }
+  auto observer = (*observer_builder_)(private_arghs, out_stream);
+  this->integrate_orbit(pusher.get(), observer.get(), time_final);
+  return out_stream.str();
+}
+
+int ensemble_server::open_listening_socket(const std::string& path) const {
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path))
+    throw std::runtime_error("socket path too long: " + path + ".\n");
+  std::strcpy(address.sun_path, path.c_str());
+  unlink(path.c_str());
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0 ||
+      bind(listener, (sockaddr*)&address, sizeof(address)) != 0 ||
+      listen(listener, SOMAXCONN) != 0)
+    throw std::runtime_error("cannot listen on socket " + path + ".\n");
+  return listener;
+}
+
+int ensemble_server::operator()(int argc, char* argv[]) const {
+  std::string socket_path;
+  argh_line_("socket", "gtrace.socket") >> socket_path;
+  size_t n_threads = std::max(1u, std::thread::hardware_concurrency());
+  argh_line_("threads", n_threads) >> n_threads;
+  size_t queue_size = 4 * n_threads;
+  argh_line_("queue-size", queue_size) >> queue_size;
+  bounded_queue<gyron_task_t> task_queue(queue_size);
+  auto topology =
+      (argh_line_["numa"] ? std::make_unique<numa_topology>() : nullptr);
+  sigset_t stop_signals;
+  sigemptyset(&stop_signals);
+  sigaddset(&stop_signals, SIGINT);
+  sigaddset(&stop_signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
+  std::vector<std::jthread> workers;
+  for (size_t i = 0; i < n_threads; i++)
+    workers.emplace_back([&, i]() {
+      if (topology) topology->bind_thread(topology->domain_of(i));
+      auto field = create_linked_field_box(argh_line_);
+      while (auto task = task_queue.pop()) {
+        try {
+          task->output.set_value(
+              this->integrate_gyron(task->private_options, field.get()));
+        } catch (...) {
+          task->output.set_exception(std::current_exception());
+        }
+      }
+    });
+  int listener = this->open_listening_socket(socket_path);
+  std::cout << this->header_string(argc, argv) << "\n"
+            << "# listening on " << socket_path << std::endl;
+  std::atomic<bool> is_stopping = false;
+  std::jthread signal_waiter([&]() {
+    int signal;
+    sigwait(&stop_signals, &signal);
+    is_stopping = true;
+    shutdown(listener, SHUT_RDWR);
+  });
+  std::list<client_t> clients;
+  auto reap_clients = [&](bool is_finished_only) {
+    for (auto it = clients.begin(); it != clients.end();) {
+      if (is_finished_only && !it->is_finished) {
+        it++;
+        continue;
+      }
+      it->thread.join();
+      close(it->connection);
+      it = clients.erase(it);
+    }
+  };
+  while (!is_stopping) {
+    int connection = accept(listener, nullptr, nullptr);
+    reap_clients(true);
+    if (connection < 0) continue;
+    client_t& client = clients.emplace_back(connection);
+    client.thread = std::jthread([&, this]() {
+      this->serve_job(client.connection, task_queue, queue_size);
+      client.is_finished = true;
+    });
+  }
+  for (client_t& client : clients) shutdown(client.connection, SHUT_RD);
+  reap_clients(false);
+  task_queue.close();
+  workers.clear();
+  close(listener);
+  unlink(socket_path.c_str());
+  std::cout << "# stopped" << std::endl;
+  return 0;
+}
+
+void ensemble_server::serve_job(
+    int connection, bounded_queue<gyron_task_t>& task_queue,
+    size_t queue_size) const {
+  bounded_queue<std::future<std::string>> outputs(queue_size);
+  std::jthread sender([&]() {
+    bool is_connected = true;
+    while (auto output = outputs.pop()) {
+      std::string block;
+      try {
+        block = output->get();
+      } catch (const std::exception& error) {
+        block = std::string("# error: ") + error.what() + "\n";
+      }
+      for (size_t sent = 0; is_connected && sent < block.size();) {
+        ssize_t n = send(
+            connection, block.data() + sent, block.size() - sent,
+            MSG_NOSIGNAL);
+        if (n < 0) is_connected = false;
+        else sent += n;
+      }
+    }
+  });
+  auto submit = [&](std::string&& private_options) {
+    gyron_task_t task = {
+        .private_options = std::move(private_options), .output = {}};
+    outputs.push(task.output.get_future());
+    task_queue.push(std::move(task));
+  };
+  std::string buffer;
+  char chunk[65536];
+  for (ssize_t n; (n = read(connection, chunk, sizeof(chunk))) > 0;) {
+    buffer.append(chunk, n);
+    size_t begin = 0;
+    for (size_t end; (end = buffer.find('\n', begin)) != std::string::npos;
+         begin = end + 1)
+      submit(buffer.substr(begin, end - begin));
+    buffer.erase(0, begin);
+  }
+  if (!buffer.empty()) submit(std::move(buffer));
+  outputs.close();
+  sender.join();
+  shutdown(connection, SHUT_RDWR);
+}
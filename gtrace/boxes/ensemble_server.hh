@@ -0,0 +1,91 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/ensemble_server.hh, this file is part of gtrace.
+
+#ifndef GTRACE_ENSEMBLE_SERVER
+#define GTRACE_ENSEMBLE_SERVER
+
+#include <gtrace/boxes/driver_box.hh>
+#include <gtrace/tools/bounded_queue.hh>
+
+#include <atomic>
+#include <future>
+#include <string>
+#include <thread>
+
+/*!
+Resident server integrating ensemble jobs submitted over a Unix socket.
+-----------------------------------------------------------------------
+
+Builds the field boxes (one per worker thread) and parses the shared options
+once, at startup, and then keeps listening on the Unix-domain socket `-socket`
+for ensemble jobs, so each job pays only for the integration of its gyrons. A
+job is a connection on which the client writes the private options of each
+gyron, one line per gyron as in the input files of `ensemble_async`, and then
+shuts down its writing side (eg, `nc -U -N socket < ensemble`). The output block
+of each gyron is streamed back through the same connection, in the order of the
+input lines, as soon as it is ready; the connection is closed after the last
+one. An orbit that fails (eg, leaves the field domain) is reported as a block
+with a single `# error: message` line.
+
+Jobs are served concurrently: each connection feeds its gyrons into a queue
+shared by all workers, so the gyrons of different jobs are integrated side by
+side, while its pending outputs are bounded by `-queue-size` (a client not
+reading its results holds back only its own job). The server runs until it gets
+SIGINT or SIGTERM: it then stops accepting jobs, ends the input of those in
+progress (as if their clients had shut down writing), sends back the outputs of
+the gyrons already submitted, and exits once all threads are joined, removing
+the socket. Only pusher and observer options and `-tfinal` may be private, the
+field boxes are built from the shared options alone.
+
+Driver options:
+
+ + `-numa` Pins the worker threads to NUMA domains (see `numa_topology`).
+ + `-queue-size=val` Capacity of the task and output queues (default 4*threads).
+ + `-sci-16` Turns on 16-digit scientific format for numeric output.
+ + `-socket=val` Path of the Unix socket (default `gtrace.socket`).
+ + `-tfinal=val` Time-integration limit (default 1, in `pusher_box_t` units).
+ + `-threads=val` Number of worker threads (defaults to the number of cores).
+!*/
+class ensemble_server : public driver_box_t {
+ public:
+  ensemble_server(int argc, char* argv[]);
+  virtual ~ensemble_server() {};
+  virtual int operator()(int argc, char* argv[]) const;
+ private:
+  struct gyron_task_t {
+    std::string private_options;
+    std::promise<std::string> output;
+  };
+  struct client_t {
+    client_t(int fd) : connection(fd) {};
+    const int connection;
+    std::jthread thread;
+    std::atomic<bool> is_finished = false;
+  };
+  double time_final_;
+  const std::unique_ptr<pusher_builder_t> pusher_builder_;
+  const std::unique_ptr<observer_builder_t> observer_builder_;
+  std::string integrate_gyron(
+      const std::string& private_options, const field_box_t* field) const;
+  int open_listening_socket(const std::string& path) const;
+  void serve_job(
+      int connection, bounded_queue<gyron_task_t>& task_queue,
+      size_t queue_size) const;
+};
+
+#endif  // GTRACE_ENSEMBLE_SERVER
@@ -24,19 +24,70 @@
 #include <gtrace/tools/argh.h>
 
 #include <memory>
+#include <span>
+#include <stdexcept>
 
+using gyronimo::IR3;
 using gyronimo::IR3field;
 using gyronimo::metric_covariant;
 
+/*!
+Base class for field boxes.
+---------------------------
+
+Besides the fields and their metric, `magnetic_magnitudes()` evaluates the
+magnetic-field magnitude at a whole batch of positions at once (eg, those of all
+gyrons advanced together by `ensemble_lockstep`). The default calls
+`get_magnetic_field()->magnitude()` once per position; boxes whose fields have
+a cheaper batched evaluation (eg, reusing each spectral mode over the batch)
+override it, with results equal to the per-position ones. Boxes whose fields
+keep mutable state between evaluations (eg, caches) return false from
+`is_thread_safe()`, so drivers sharing one box among threads build one per
+thread instead.
+
+Boxes may also expose the potentials that the invariants of the orbits depend on
+(see `pusher_box_t::compose_invariant_fields()`): those whose electric field
+derives from a scalar potential return true from `has_electric_potential()` and
+give it (in volts) by `get_electric_potential()`, so the total energy is known;
+those whose fields are both independent of `qw` return true from
+`is_axisymmetric()` and give, by `get_poloidal_flux()`, the poloidal flux over
+$2\pi$ (in Wb, ie, T m$^2$) such that the covariant `qw` component of the vector
+potential is minus that flux, so the canonical momentum conjugate to `qw` is
+known. The defaults expose neither, and their getters throw.
+!*/
 class field_box_t {
  public:
   virtual ~field_box_t() {};
   virtual const IR3field* get_electric_field() const = 0;
   virtual const IR3field* get_magnetic_field() const = 0;
   virtual const metric_covariant* get_metric() const = 0;
+  virtual void magnetic_magnitudes(
+      std::span<const IR3> positions, double time,
+      std::span<double> magnitudes) const;
+  virtual bool is_thread_safe() const { return true; };
+  virtual bool has_electric_potential() const { return false; };
+  virtual double get_electric_potential(const IR3& q, double time) const;
+  virtual bool is_axisymmetric() const { return false; };
+  virtual double get_poloidal_flux(const IR3& q, double time) const;
   bool is_metric_consistent() const;
 };
 
+inline double field_box_t::get_electric_potential(const IR3&, double) const {
+  throw std::runtime_error("field_box_t has no electric potential.");
+}
+
+inline double field_box_t::get_poloidal_flux(const IR3&, double) const {
+  throw std::runtime_error("field_box_t has no poloidal flux.");
+}
+
+inline void field_box_t::magnetic_magnitudes(
+    std::span<const IR3> positions, double time,
+    std::span<double> magnitudes) const {
+  const IR3field* B = this->get_magnetic_field();
+  for (size_t i = 0; i < positions.size(); i++)
+    magnitudes[i] = B->magnitude(positions[i], time);
+}
+
 inline bool field_box_t::is_metric_consistent() const {
   const IR3field* E = this->get_electric_field();
   const IR3field* B = this->get_magnetic_field();
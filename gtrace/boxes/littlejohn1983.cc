@@ -20,9 +20,35 @@
 #include <gyronimo/metrics/metric_connected.hh>
 
 #include <gtrace/boxes/littlejohn1983.hh>
+#include <gtrace/tools/binary_io.hh>
+#include <gtrace/tools/layered_arghs.hh>
 #include <gtrace/tools/odeint_wrapper.hh>
 
 #include <algorithm>
+#include <cmath>
+#include <sstream>
+
+std::string littlejohn1983::compose_invariant_fields() const {
+  std::string fields = (this->is_energy_invariant() ? "energy" : "");
+  if (field_box_->is_axisymmetric())
+    fields += (fields.empty() ? "Pphi" : " Pphi");
+  return fields;
+}
+
+std::list<double> littlejohn1983::compose_invariant_values(double time) const {
+  std::list<double> values;
+  if (this->is_energy_invariant())
+    values.push_back(this->get_total_energy(time, settings_.charge));
+  if (field_box_->is_axisymmetric()) {
+    IR3 q = eqs_motion_.get_position(state_);
+    const IR3field* B = field_box_->get_magnetic_field();
+    double b_w = B->covariant(q, time)[IR3::w] / B->magnitude(q, time);
+    double v_w = eqs_motion_.get_vpp(state_) * settings_.vref * b_w;
+    values.push_back(this->get_toroidal_momentum(
+        time, v_w, settings_.charge / settings_.mass));
+  }
+  return values;
+}
 
 std::string littlejohn1983::compose_output_fields() const {
   std::string output_fields("# fields: t qu qv qw vpar");
@@ -56,15 +82,34 @@ std::list<double> littlejohn1983::compose_output_values(double time) const {
   return output_values;
 }
 
+std::string littlejohn1983::compose_state_signature() const {
+  std::ostringstream signature;
+  signature.precision(17);
+  signature << "littlejohn1983 odeint=" << settings_.odeint
+            << " dt=" << time_step_ << " charge=" << settings_.charge
+            << " lref=" << settings_.lref << " mass=" << settings_.mass
+            << " vref=" << settings_.vref;
+  return signature.str();
+}
+
 IR3 littlejohn1983::get_dot_q(double time) const {
   auto ds = eqs_motion_(state_, time);
   return {ds[0], ds[1], ds[2]};
 };
 
-double littlejohn1983::get_energy_tilde(const settings_t& s) {
+double littlejohn1983::get_energy(double time) const {
+  double energy_tilde = eqs_motion_.energy_parallel(state_) +
+                        eqs_motion_.energy_perpendicular(state_, time);
+  return energy_tilde * get_energy_ref_ev(settings_);
+}
+
+double littlejohn1983::get_energy_ref_ev(const settings_t& s) {
   using gyronimo::codata::e, gyronimo::codata::m_proton;
-  const double energy_ref_ev = 0.5 * m_proton * s.mass * s.vref * s.vref / e;
-  return s.energy / energy_ref_ev;
+  return 0.5 * m_proton * s.mass * s.vref * s.vref / e;
+}
+
+double littlejohn1983::get_energy_tilde(const settings_t& s) {
+  return s.energy / get_energy_ref_ev(s);
 }
 
 double littlejohn1983::get_mu_tilde(
@@ -74,6 +119,14 @@ double littlejohn1983::get_mu_tilde(
   return (1 - s.pitch * s.pitch) * get_energy_tilde(s) / B;
 }
 
+double littlejohn1983::get_pitch(double time) const {
+  double energy_parallel = eqs_motion_.energy_parallel(state_);
+  double energy =
+      energy_parallel + eqs_motion_.energy_perpendicular(state_, time);
+  double pitch = (energy > 0 ? std::sqrt(energy_parallel / energy) : 0);
+  return (eqs_motion_.get_vpp(state_) < 0 ? -pitch : pitch);
+}
+
 IR3 littlejohn1983::get_q(double time) const {
   return eqs_motion_.get_position(state_);
 };
@@ -99,25 +152,46 @@ littlejohn1983::littlejohn1983(const settings_t& s, const field_box_t* fb)
       (s.pitch < 0 ? guiding_centre::minus : guiding_centre::plus), 0);
 }
 
+void littlejohn1983::load_state(std::istream& is) {
+  read_binary(is, state_);
+  stepper_->load_history(is);
+}
+
 littlejohn1983::settings_t littlejohn1983::parse_settings(
     const argh::parser& arghs) {
-  settings_t settings;
-  arghs("samples", 512) >> settings.samples;
-  arghs("tfinal", 1) >> settings.time_final;
-  arghs("lref", 1) >> settings.lref;
-  arghs("vref", 1) >> settings.vref;
-  arghs("mass", 1) >> settings.mass;
-  arghs("charge", 1) >> settings.charge;
-  arghs("qu", 0.1) >> settings.qu;
-  arghs("qv", 0) >> settings.qv;
-  arghs("qw", 0) >> settings.qw;
-  arghs("energy", 1) >> settings.energy;
-  arghs("pitch", 0.5) >> settings.pitch;
-  arghs("gyrophase", 0) >> settings.gyrophase;
-  arghs("odeint", "rungekutta") >> settings.odeint;
-  settings.pb = arghs["pb"];
-  settings.pjac = arghs["pjac"];
-  settings.pkin = arghs["pkin"];
-  settings.pxyz = arghs["pxyz"];
+  settings_t defaults = {
+      .samples = 512, .charge = 1, .lref = 1, .mass = 1, .time_final = 1,
+      .vref = 1, .qu = 0.1, .qv = 0, .qw = 0, .energy = 1, .gyrophase = 0,
+      .pitch = 0.5, .weight = 1, .pb = false, .pjac = false, .pkin = false,
+      .pxyz = false, .odeint = "rungekutta"};
+  return parse_settings(arghs, defaults);
+}
+
+littlejohn1983::settings_t littlejohn1983::parse_settings(
+    const argh::parser& arghs, const settings_t& base) {
+  settings_t settings = base;
+  arghs("samples", base.samples) >> settings.samples;
+  arghs("tfinal", base.time_final) >> settings.time_final;
+  arghs("lref", base.lref) >> settings.lref;
+  arghs("vref", base.vref) >> settings.vref;
+  arghs("mass", base.mass) >> settings.mass;
+  arghs("charge", base.charge) >> settings.charge;
+  arghs("qu", base.qu) >> settings.qu;
+  arghs("qv", base.qv) >> settings.qv;
+  arghs("qw", base.qw) >> settings.qw;
+  arghs("energy", base.energy) >> settings.energy;
+  arghs("pitch", base.pitch) >> settings.pitch;
+  arghs("gyrophase", base.gyrophase) >> settings.gyrophase;
+  arghs("weight", base.weight) >> settings.weight;
+  arghs("odeint", base.odeint) >> settings.odeint;
+  settings.pb = layered_flag(arghs, "pb", base.pb);
+  settings.pjac = layered_flag(arghs, "pjac", base.pjac);
+  settings.pkin = layered_flag(arghs, "pkin", base.pkin);
+  settings.pxyz = layered_flag(arghs, "pxyz", base.pxyz);
   return settings;
 }
+
+void littlejohn1983::save_state(std::ostream& os) const {
+  write_binary(os, state_);
+  stepper_->save_history(os);
+}
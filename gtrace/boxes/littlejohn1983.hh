@@ -56,6 +56,7 @@ Pusher options:
     $v_\parallel/v$).
 
  + `-samples=val` Number of time samples (`tfinal/time_step`, default 512).
+ + `-weight=val` Statistical weight of the gyron (default 1).
  + `-odeint={adams|fehlberg|rungekutta}` ODE algorithm (defaults to rungekutta).
 
 Options controlling the output:
@@ -71,11 +72,13 @@ class littlejohn1983 : public pusher_box_t {
   struct settings_t {
     size_t samples;
     double charge, lref, mass, time_final, vref;
-    double qu, qv, qw, energy, gyrophase, pitch;
+    double qu, qv, qw, energy, gyrophase, pitch, weight;
     bool pb, pjac, pkin, pxyz;
     std::string odeint;
   };
   static settings_t parse_settings(const argh::parser& arghs);
+  static settings_t parse_settings(
+      const argh::parser& arghs, const settings_t& base_settings);
 
   littlejohn1983(const settings_t& settings, const field_box_t* field_box);
   virtual ~littlejohn1983() {};
@@ -86,6 +89,15 @@ class littlejohn1983 : public pusher_box_t {
   virtual IR3 get_q(double time) const override;
   virtual std::string compose_output_fields() const override;
   virtual std::list<double> compose_output_values(double time) const override;
+  virtual std::string compose_invariant_fields() const override;
+  virtual std::list<double> compose_invariant_values(
+      double time) const override;
+  virtual double get_energy(double time) const override;
+  virtual double get_pitch(double time) const override;
+  virtual double get_weight() const override { return settings_.weight; };
+  virtual void save_state(std::ostream& os) const override;
+  virtual void load_state(std::istream& is) override;
+  virtual std::string compose_state_signature() const override;
  private:
   const double time_step_;
   const settings_t settings_;
@@ -93,6 +105,7 @@ class littlejohn1983 : public pusher_box_t {
   const std::unique_ptr<odeint_stepper<guiding_centre>> stepper_;
   state_t state_;
 
+  static double get_energy_ref_ev(const settings_t& s);
   static double get_energy_tilde(const settings_t& s);
   static double get_mu_tilde(const settings_t& s, const field_box_t* fb);
   static bool is_pxyz_inconsistent(const settings_t& s, const field_box_t* fb);
@@ -0,0 +1,28 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/observer_box.cc, this file is part of gtrace.
+
+#include <gtrace/boxes/observer_box.hh>
+
+// Weak default, overridden by the factories defining a builder of their own.
+__attribute__((weak)) std::unique_ptr<observer_builder_t>
+create_linked_observer_builder(const argh::parser& shared_arghs) {
+  return std::make_unique<merged_observer_builder>(shared_arghs);
+}
+
+// Weak default, overridden by the factories of observers with reductions.
+__attribute__((weak)) void register_linked_reductions(const argh::parser&) {}
@@ -20,6 +20,7 @@
 #define GTRACE_OBSERVER_BOX
 
 #include <gtrace/boxes/pusher_box.hh>
+#include <gtrace/tools/layered_arghs.hh>
 
 class observer_box_t {
  public:
@@ -27,11 +28,74 @@ class observer_box_t {
   observer_box_t(std::ostream& os) : ostream_(os) {};
   virtual ~observer_box_t() {};
   virtual bool operator()(const pusher_box_t* pusher, double time) const = 0;
+  virtual void flush() const {};
  protected:
   std::ostream& ostream_;
 };
 
+/*!
+Builds observers for an ensemble from layered settings.
+-------------------------------------------------------
+
+The counterpart of `pusher_builder_t` for observers: the shared options are
+parsed only once, at construction, and each gyron's observer is then built from
+these shared settings overlaid by the (short) list of options particular to that
+gyron, to which ensemble drivers add its id as `-gyron-id` (eg, for
+`orbit_summary`). Any concrete observer with a `settings_t` type, static
+`parse_settings(arghs)` and `parse_settings(arghs, base_settings)` members, and
+a constructor taking `(settings, os)` fits `layered_observer_builder<Observer>`.
+Observers without a builder of their own (eg, out-of-tree ones linking only
+`create_linked_observer_box()`) are built by `merged_observer_builder`, which
+merges the shared and private options into a full parser for each gyron (see
+`layered_arghs()`).
+!*/
+class observer_builder_t {
+ public:
+  virtual ~observer_builder_t() {};
+  virtual std::unique_ptr<observer_box_t> operator()(
+      const argh::parser& private_arghs, std::ostream& os) const = 0;
+};
+
+template<typename Observer>
+class layered_observer_builder : public observer_builder_t {
+ public:
+  using settings_t = Observer::settings_t;
+  layered_observer_builder(const argh::parser& shared_arghs)
+      : shared_settings_(Observer::parse_settings(shared_arghs)) {};
+  virtual ~layered_observer_builder() {};
+  virtual std::unique_ptr<observer_box_t> operator()(
+      const argh::parser& private_arghs, std::ostream& os) const override {
+    settings_t settings =
+        Observer::parse_settings(private_arghs, shared_settings_);
+    return std::make_unique<Observer>(settings, os);
+  };
+ private:
+  const settings_t shared_settings_;
+};
+
 std::unique_ptr<observer_box_t> create_linked_observer_box(
     const argh::parser& arghs, std::ostream& os);
 
+class merged_observer_builder : public observer_builder_t {
+ public:
+  merged_observer_builder(const argh::parser& shared_arghs)
+      : shared_arghs_(shared_arghs) {};
+  virtual ~merged_observer_builder() {};
+  virtual std::unique_ptr<observer_box_t> operator()(
+      const argh::parser& private_arghs, std::ostream& os) const override {
+    return create_linked_observer_box(
+        layered_arghs(shared_arghs_, private_arghs), os);
+  };
+ private:
+  const argh::parser shared_arghs_;
+};
+
+std::unique_ptr<observer_builder_t> create_linked_observer_builder(
+    const argh::parser& shared_arghs);
+
+// Registers in the calling thread the `reduction_registry` entries that the
+// linked observer accumulates into, without building it (a weak default
+// registers none, thus only factories of observers with reductions define it).
+void register_linked_reductions(const argh::parser& arghs);
+
 #endif  // GTRACE_OBSERVER_BOX
@@ -0,0 +1,92 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/orbit_summary.cc, this file is part of gtrace.
+
+#include <gtrace/boxes/orbit_summary.hh>
+#include <gtrace/tools/text_record.hh>
+
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+void orbit_summary::flush() const {
+  if (samples_ == 0) return;
+  constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+  double elapsed = time_ - time_0_;
+  size_t periods = (reversals_ > 0 ? (reversals_ - 1) / 2 : 0);
+  double period_time = last_period_end_.time - first_reversal_.time;
+  bool is_trapped = (reversals_ > 0);
+  double bounce_time = (periods > 0 ? period_time / periods : nan);
+  double poloidal_shift = std::abs(q_[IR3::v] - q_0_[IR3::v]);
+  double transit_time =
+      (!is_trapped && poloidal_shift > 0
+           ? 2 * std::numbers::pi * elapsed / poloidal_shift
+           : nan);
+  double precession = nan;
+  if (is_trapped && periods > 0)
+    precession = (last_period_end_.qw - first_reversal_.qw) / period_time;
+  else if (!is_trapped && elapsed > 0)
+    precession = (q_[IR3::w] - q_0_[IR3::w]) / elapsed;
+  ostream_ << "# summary: " << (gyron_id_.empty() ? "" : "id ")
+           << "tfinal qu_min qu_max qu_mean B_mean reversals "
+           << "trapped bounce_time transit_time precession\n";
+  if (!gyron_id_.empty()) ostream_ << gyron_id_ << " ";
+  text_record::write(
+      ostream_, {time_, qu_min_, qu_max_,
+                 (elapsed > 0 ? qu_integral_ / elapsed : q_[IR3::u]),
+                 (elapsed > 0 ? b_integral_ / elapsed : nan),
+                 (double)reversals_, (double)is_trapped, bounce_time,
+                 transit_time, precession});
+  samples_ = 0;
+}
+
+bool orbit_summary::operator()(const pusher_box_t* pusher, double time) const {
+  IR3 q = pusher->get_q(time);
+  double pitch = pusher->get_pitch(time);
+  double b = pusher->field_box()->get_magnetic_field()->magnitude(q, time);
+  if (samples_ == 0) {
+    time_0_ = time, q_0_ = q;
+    qu_min_ = qu_max_ = q[IR3::u];
+    qu_integral_ = b_integral_ = 0;
+    reversals_ = 0;
+  } else {
+    qu_integral_ += 0.5 * (q_[IR3::u] + q[IR3::u]) * (time - time_);
+    b_integral_ += 0.5 * (b_ + b) * (time - time_);
+    qu_min_ = std::min(qu_min_, q[IR3::u]);
+    qu_max_ = std::max(qu_max_, q[IR3::u]);
+    if (std::signbit(pitch) != std::signbit(pitch_)) {
+      reversals_++;
+      if (reversals_ == 1) first_reversal_ = {time, q[IR3::w]};
+      else if (reversals_ % 2 == 1) last_period_end_ = {time, q[IR3::w]};
+    }
+  }
+  time_ = time, q_ = q, pitch_ = pitch, b_ = b;
+  samples_++;
+  return true;
+}
+
+orbit_summary::settings_t orbit_summary::parse_settings(
+    const argh::parser& arghs) {
+  return parse_settings(arghs, {.gyron_id = ""});
+}
+
+orbit_summary::settings_t orbit_summary::parse_settings(
+    const argh::parser& arghs, const settings_t& base) {
+  settings_t settings = base;
+  arghs("gyron-id", base.gyron_id) >> settings.gyron_id;
+  return settings;
+}
@@ -0,0 +1,86 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/orbit_summary.hh, this file is part of gtrace.
+
+#ifndef GTRACE_ORBIT_SUMMARY
+#define GTRACE_ORBIT_SUMMARY
+
+#include <gtrace/boxes/observer_box.hh>
+
+#include <string>
+
+/*!
+Per-orbit summary of invariant diagnostics.
+-------------------------------------------
+
+Accumulates, step by step and without storing the orbit, a few diagnostics of
+the whole orbit, written by `flush()` (called by drivers once the orbit ends)
+as a single row preceded by the line `# summary:` naming its columns:
+
+ + `id` The gyron's `-gyron-id` (set by the ensemble drivers), if any.
+ + `tfinal` Time of the last step (in `pusher_box_t` units).
+ + `qu_min, qu_max, qu_mean` Radial excursion and time-averaged `qu`.
+ + `B_mean` Time-averaged magnetic-field norm.
+ + `reversals` Number of sign reversals of $v_\parallel$ (ie, bounces).
+ + `trapped` 1 if $v_\parallel$ reversed at least once, 0 otherwise.
+ + `bounce_time` Mean time of a full bounce period (two reversals).
+ + `transit_time` Mean time taken by a passing orbit to cover $2\pi$ in `qv`.
+ + `precession` Mean rate of change of `qw`.
+
+The orbit is assumed to be traced in the coordinates of `vmec_b` (ie, `qu`
+radial, `qv` poloidal and `qw` toroidal angles, in radians, unwrapped along
+the orbit). The precession of trapped orbits is measured over whole bounce
+periods (ie, between the first and last reversals an even number of reversals
+apart) and that of passing orbits over the whole orbit. Diagnostics undefined
+for the orbit (eg, the bounce time of passing orbits or of trapped ones with
+fewer than three reversals) are written as `nan`.
+
+The id column lets the summaries of an ensemble be matched to their gyrons
+whatever the order of the output blocks (eg, `ensemble_hybrid_mpi`).
+
+Observer options:
+
+ + `-gyron-id=val` Gyron identifier heading the summary row (default none).
+!*/
+class orbit_summary : public observer_box_t {
+ public:
+  struct settings_t {
+    std::string gyron_id;
+  };
+  static settings_t parse_settings(const argh::parser& arghs);
+  static settings_t parse_settings(
+      const argh::parser& arghs, const settings_t& base_settings);
+  orbit_summary() = delete;
+  orbit_summary(const settings_t& settings, std::ostream& os)
+      : observer_box_t(os), gyron_id_(settings.gyron_id) {};
+  virtual ~orbit_summary() {};
+  virtual bool operator()(
+      const pusher_box_t* pusher, double time) const override;
+  virtual void flush() const override;
+ private:
+  struct reversal_t {
+    double time, qw;
+  };
+  const std::string gyron_id_;
+  mutable size_t samples_ = 0, reversals_ = 0;
+  mutable double time_0_, time_, pitch_, b_;
+  mutable IR3 q_0_, q_;
+  mutable double qu_min_, qu_max_, qu_integral_ = 0, b_integral_ = 0;
+  mutable reversal_t first_reversal_, last_period_end_;
+};
+
+#endif  // GTRACE_ORBIT_SUMMARY
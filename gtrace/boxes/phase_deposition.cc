@@ -0,0 +1,88 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/phase_deposition.cc, this file is part of gtrace.
+
+#include <gtrace/boxes/phase_deposition.hh>
+#include <gtrace/tools/layered_arghs.hh>
+
+#include <stdexcept>
+
+bool phase_deposition::operator()(
+    const pusher_box_t* pusher, double time) const {
+  if (skipped_steps_ < skip_) {
+    skipped_steps_++;
+    return true;
+  }
+  IR3 q = pusher->get_q(time);
+  for (size_t i = 0; i < coordinates_.size(); i++) {
+    switch (coordinates_[i]) {
+      case coordinate_t::qu: point_[i] = q[IR3::u]; break;
+      case coordinate_t::qv: point_[i] = q[IR3::v]; break;
+      case coordinate_t::qw: point_[i] = q[IR3::w]; break;
+      case coordinate_t::energy: point_[i] = pusher->get_energy(time); break;
+      case coordinate_t::pitch: point_[i] = pusher->get_pitch(time); break;
+    }
+  }
+  grid_->deposit(point_, pusher->get_weight());
+  skipped_steps_ = 0;
+  return true;
+}
+
+phase_deposition::settings_t phase_deposition::parse_settings(
+    const argh::parser& arghs) {
+  settings_t settings =
+      parse_settings(arghs, {.axes = {}, .skip = 0, .skip_initial = false});
+  if (settings.axes.empty())
+    throw std::invalid_argument("phase_deposition: missing -deposit.");
+  return settings;
+}
+
+phase_deposition::settings_t phase_deposition::parse_settings(
+    const argh::parser& arghs, const settings_t& base) {
+  settings_t settings = base;
+  std::string axes_list;
+  if (arghs("deposit") >> axes_list)
+    settings.axes = phase_grid::parse_axes(axes_list);
+  arghs("skip", base.skip) >> settings.skip;
+  settings.skip_initial =
+      layered_flag(arghs, "skip-initial", base.skip_initial);
+  return settings;
+}
+
+phase_deposition::coordinate_t phase_deposition::parse_coordinate(
+    const std::string& name) {
+  if (name == "qu") return coordinate_t::qu;
+  if (name == "qv") return coordinate_t::qv;
+  if (name == "qw") return coordinate_t::qw;
+  if (name == "energy") return coordinate_t::energy;
+  if (name == "pitch") return coordinate_t::pitch;
+  throw std::invalid_argument("phase_deposition: unknown axis " + name + ".");
+}
+
+phase_deposition::phase_deposition(
+    const settings_t& settings, std::ostream& os)
+    : observer_box_t(os), grid_(&local_grid(settings)), skip_(settings.skip),
+      skipped_steps_(settings.skip_initial ? 0 : settings.skip) {
+  for (const phase_grid::axis_t& axis : grid_->axes())
+    coordinates_.push_back(parse_coordinate(axis.name));
+  point_.resize(grid_->axes().size());
+}
+
+phase_grid& phase_deposition::local_grid(const settings_t& settings) {
+  return reduction_registry::global().local<phase_grid>(
+      "phase_deposition", settings.axes);
+}
@@ -0,0 +1,78 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/phase_deposition.hh, this file is part of gtrace.
+
+#ifndef GTRACE_PHASE_DEPOSITION
+#define GTRACE_PHASE_DEPOSITION
+
+#include <gtrace/boxes/observer_box.hh>
+#include <gtrace/tools/phase_grid.hh>
+
+#include <vector>
+
+/*!
+Online deposition of the ensemble over a phase-space grid.
+----------------------------------------------------------
+
+At every time step (eventually skipping some), adds the gyron's weight (see
+`pusher_box_t::get_weight()`) to the cell of a `phase_grid` holding its current
+state, over the axes listed by `-deposit` among `qu`, `qv`, `qw` (position, as
+defined by the `field_box_t`), `energy` (kinetic, eV), and `pitch`
+($v_\parallel/v$); eg, `-deposit=qu:0:1:64,energy:0:1e5:50,pitch:-1:1:40`.
+Nothing is printed per step: the grid is the calling thread's copy in the
+`reduction_registry`, and the drivers sum all copies over threads and MPI
+processes and write the final grid once, at the end of the output, thus
+distribution functions are obtained without tracing full orbits to disk. Each
+sample contributes the full weight, irrespective of the time step (ie, the grid
+holds weighted sample counts, to be normalised by the number of samples). Gyrons
+interrupted by the walltime contribute the part of their orbits integrated.
+Since journals cannot restore the grid, drivers refuse `-journal` with this
+observer (see `driver_box_t`).
+
+Observer options:
+
+ + `-deposit=list` Grid axes, as `name:min:max:bins` items (required).
+ + `-skip=val` Number of time steps to be skipped (default 0).
+ + `-skip-initial` Skips also the step corresponding to time=0.
+!*/
+class phase_deposition : public observer_box_t {
+ public:
+  struct settings_t {
+    std::vector<phase_grid::axis_t> axes;
+    size_t skip;
+    bool skip_initial;
+  };
+  static settings_t parse_settings(const argh::parser& arghs);
+  static settings_t parse_settings(
+      const argh::parser& arghs, const settings_t& base_settings);
+  phase_deposition() = delete;
+  phase_deposition(const settings_t& settings, std::ostream& os);
+  virtual ~phase_deposition() {};
+  virtual bool operator()(
+      const pusher_box_t* pusher, double time) const override;
+  static phase_grid& local_grid(const settings_t& settings);
+ private:
+  enum class coordinate_t { qu, qv, qw, energy, pitch };
+  std::vector<coordinate_t> coordinates_;
+  phase_grid* const grid_;
+  const size_t skip_;
+  mutable size_t skipped_steps_;
+  mutable std::vector<double> point_;
+  static coordinate_t parse_coordinate(const std::string& name);
+};
+
+#endif  // GTRACE_PHASE_DEPOSITION
@@ -16,6 +16,8 @@
 
 // @boxes/pusher_box.cc, this file is part of gtrace.
 
+#include <gyronimo/core/codata.hh>
+
 #include <gtrace/boxes/pusher_box.hh>
 
 pusher_box_t::pusher_box_t(const field_box_t* field_box)
@@ -24,3 +26,51 @@ pusher_box_t::pusher_box_t(const field_box_t* field_box)
   if (!field_box->is_metric_consistent())
     throw std::runtime_error("inconsistent metrics in field_box_t.");
 }
+
+std::string pusher_box_t::compose_state_signature() const {
+  throw std::runtime_error("pusher_box_t cannot save checkpoints.");
+}
+
+std::string pusher_box_t::compose_invariant_fields() const {
+  throw std::runtime_error("pusher_box_t has no invariants.");
+}
+
+std::list<double> pusher_box_t::compose_invariant_values(double) const {
+  throw std::runtime_error("pusher_box_t has no invariants.");
+}
+
+double pusher_box_t::get_energy(double) const {
+  throw std::runtime_error("pusher_box_t cannot compute the energy.");
+}
+
+double pusher_box_t::get_pitch(double) const {
+  throw std::runtime_error("pusher_box_t cannot compute the pitch.");
+}
+
+double pusher_box_t::get_toroidal_momentum(
+    double time, double v_w, double charge_mass) const {
+  using gyronimo::codata::e, gyronimo::codata::m_proton;
+  double flux = field_box_->get_poloidal_flux(this->get_q(time), time);
+  return v_w - charge_mass * (e / m_proton) * flux;
+}
+
+double pusher_box_t::get_total_energy(double time, double charge) const {
+  double energy = this->get_energy(time);
+  if (field_box_->get_electric_field())
+    energy +=
+        charge * field_box_->get_electric_potential(this->get_q(time), time);
+  return energy;
+}
+
+bool pusher_box_t::is_energy_invariant() const {
+  return !field_box_->get_electric_field() ||
+         field_box_->has_electric_potential();
+}
+
+void pusher_box_t::load_state(std::istream&) {
+  throw std::runtime_error("pusher_box_t cannot load checkpoints.");
+}
+
+void pusher_box_t::save_state(std::ostream&) const {
+  throw std::runtime_error("pusher_box_t cannot save checkpoints.");
+}
@@ -23,10 +23,54 @@
 
 #include <gtrace/boxes/field_box.hh>
 
+#include <istream>
 #include <list>
+#include <memory>
+#include <ostream>
 
 using gyronimo::IR3;
 
+struct gyron_ic_t {
+  double qu, qv, qw, energy, pitch, gyrophase, weight, id;
+};
+
+template<typename Settings>
+Settings overlay_initial_condition(Settings s, const gyron_ic_t& ic) {
+  s.qu = ic.qu, s.qv = ic.qv, s.qw = ic.qw;
+  s.energy = ic.energy, s.pitch = ic.pitch, s.gyrophase = ic.gyrophase;
+  s.weight = ic.weight;
+  return s;
+}
+
+template<typename Settings>
+gyron_ic_t extract_initial_condition(const Settings& s) {
+  return {
+      .qu = s.qu, .qv = s.qv, .qw = s.qw, .energy = s.energy, .pitch = s.pitch,
+      .gyrophase = s.gyrophase, .weight = s.weight, .id = 0};
+}
+
+/*!
+Base class for pusher boxes.
+----------------------------
+
+Besides the output record, observers may query the gyron's kinetic energy (eV)
+and pitch ($v_\parallel/v$) at the current state, and its statistical weight
+(option `-weight`, or the weight column of binary ensembles), as well as the
+`field_box()` it moves in. Pushers may list the quantities their equations of
+motion conserve (eg, the kinetic energy in static magnetic fields) by name in
+`compose_invariant_fields()`, with their current values given by
+`compose_invariant_values()`, whose drift measures the integration error (see
+`drift_monitor`). The helpers `get_total_energy()` (kinetic plus potential, in
+eV) and `get_toroidal_momentum()` (the canonical momentum conjugate to `qw` per
+unit mass, in m$^2$/s) give the usual ones, the former being an invariant unless
+the field box holds an electric field without giving its potential and the
+latter only if the field box is axisymmetric (see `field_box_t`). Pushers
+supporting checkpoints save and load their state and give its
+`compose_state_signature()`, a line naming the pusher and the settings the state
+depends on (eg, the time step), so that a checkpoint is never resumed by a
+different pusher. The defaults of `get_energy()`, `get_pitch()`, the invariants,
+and the state methods throw, for pushers not providing them.
+!*/
 class pusher_box_t {
  public:
   pusher_box_t() = delete;
@@ -35,13 +79,92 @@ class pusher_box_t {
   virtual double push_state(double time) = 0;
   virtual IR3 get_q(double time) const = 0;
   virtual IR3 get_dot_q(double time) const = 0;
+  const field_box_t* field_box() const { return field_box_; };
   virtual std::string compose_output_fields() const = 0;
   virtual std::list<double> compose_output_values(double time) const = 0;
+  virtual std::string compose_invariant_fields() const;
+  virtual std::list<double> compose_invariant_values(double time) const;
+  virtual double get_energy(double time) const;
+  virtual double get_pitch(double time) const;
+  virtual double get_weight() const { return 1; };
+  virtual void save_state(std::ostream& os) const;
+  virtual void load_state(std::istream& is);
+  virtual std::string compose_state_signature() const;
  protected:
   const field_box_t* const field_box_;
+  bool is_energy_invariant() const;
+  double get_total_energy(double time, double charge) const;
+  double get_toroidal_momentum(
+      double time, double v_w, double charge_mass) const;
+};
+
+/*!
+Builds pushers for an ensemble from layered settings.
+-----------------------------------------------------
+
+The shared options are parsed only once, at construction, into the pusher's
+`settings_t`. Each gyron's pusher is then built from a copy of these shared
+settings overlaid either by the (short) list of options particular to that gyron
+or by a `gyron_ic_t` object, thus its setup cost does not depend on the length
+of the shared command line. Options set for a particular gyron take precedence
+over the shared ones. Any concrete pusher with a `settings_t` type, a static
+`parse_settings(arghs, base_settings)` member, and a constructor taking
+`(settings, field_box)` fits `layered_pusher_builder<Pusher>`. The method
+`initial_condition()` returns the initial position, energy, and pitch resolved
+from a gyron's options without building its pusher (eg, to reorder ensembles).
+!*/
+class pusher_builder_t {
+ public:
+  virtual ~pusher_builder_t() {};
+  virtual std::unique_ptr<pusher_box_t> operator()(
+      const argh::parser& private_arghs,
+      const field_box_t* field_box) const = 0;
+  virtual std::unique_ptr<pusher_box_t> operator()(
+      const gyron_ic_t& initial_condition,
+      const field_box_t* field_box) const = 0;
+  virtual gyron_ic_t initial_condition(
+      const argh::parser& private_arghs) const = 0;
+  gyron_ic_t initial_condition(const std::string& private_options) const {
+    return this->initial_condition(argh::parser(private_options));
+  };
+  gyron_ic_t initial_condition(const gyron_ic_t& initial_condition) const {
+    return initial_condition;
+  };
+};
+
+template<typename Pusher>
+class layered_pusher_builder : public pusher_builder_t {
+ public:
+  using settings_t = Pusher::settings_t;
+  layered_pusher_builder(const argh::parser& shared_arghs)
+      : shared_settings_(Pusher::parse_settings(shared_arghs)) {};
+  virtual ~layered_pusher_builder() {};
+  virtual std::unique_ptr<pusher_box_t> operator()(
+      const argh::parser& private_arghs,
+      const field_box_t* field_box) const override {
+    settings_t settings =
+        Pusher::parse_settings(private_arghs, shared_settings_);
+    return std::make_unique<Pusher>(settings, field_box);
+  };
+  virtual std::unique_ptr<pusher_box_t> operator()(
+      const gyron_ic_t& initial_condition,
+      const field_box_t* field_box) const override {
+    settings_t settings =
+        overlay_initial_condition(shared_settings_, initial_condition);
+    return std::make_unique<Pusher>(settings, field_box);
+  };
+  virtual gyron_ic_t initial_condition(
+      const argh::parser& private_arghs) const override {
+    return extract_initial_condition(
+        Pusher::parse_settings(private_arghs, shared_settings_));
+  };
+ private:
+  const settings_t shared_settings_;
 };
 
 std::unique_ptr<pusher_box_t> create_linked_pusher_box(
     const argh::parser& arghs, const field_box_t* field_box);
+std::unique_ptr<pusher_builder_t> create_linked_pusher_builder(
+    const argh::parser& shared_arghs);
 
 #endif  // GTRACE_PUSHER_BOX
@@ -17,6 +17,8 @@
 // @boxes/q_predicate.cc, this file is part of gtrace.
 
 #include <gtrace/boxes/q_predicate.hh>
+#include <gtrace/tools/layered_arghs.hh>
+#include <gtrace/tools/text_record.hh>
 
 #include <iostream>
 #include <limits>
@@ -26,7 +28,8 @@ bool q_predicate::invoke_default(
   IR3 q = pusher->get_q(time);
   if (this->is_within_bounds(q)) {
     if (time == 0)
-      for (auto x : pusher->compose_output_values(time)) ostream_ << x << " ";
+      text_record::write(
+          ostream_, pusher->compose_output_values(time), false);
     if (time >= tfinal_) this->print_last_state(pusher, time);
     return true;
   } else {
@@ -53,17 +56,37 @@ bool q_predicate::operator()(const pusher_box_t* pusher, double time) const {
   else return this->invoke_default(pusher, time);
 }
 
+q_predicate::settings_t q_predicate::parse_settings(
+    const argh::parser& arghs) {
+  settings_t defaults = {
+      .printer = {.skip = 0, .skip_initial = false},
+      .qu_min = std::numeric_limits<double>::lowest(),
+      .qu_max = std::numeric_limits<double>::max(), .time_final = 1,
+      .step_mode = false};
+  return parse_settings(arghs, defaults);
+}
+
+q_predicate::settings_t q_predicate::parse_settings(
+    const argh::parser& arghs, const settings_t& base) {
+  settings_t settings = base;
+  settings.printer = step_printer::parse_settings(arghs, base.printer);
+  arghs("qumin", base.qu_min) >> settings.qu_min;
+  arghs("qumax", base.qu_max) >> settings.qu_max;
+  arghs("tfinal", base.time_final) >> settings.time_final;
+  settings.step_mode = layered_flag(arghs, "step-mode", base.step_mode);
+  return settings;
+}
+
 void q_predicate::print_last_state(
     const pusher_box_t* pusher, double time) const {
-  for (auto x : pusher->compose_output_values(time)) ostream_ << x << " ";
-  ostream_ << "\n";
+  text_record::write(ostream_, pusher->compose_output_values(time));
 }
 
-q_predicate::q_predicate(const argh::parser& arghs, std::ostream& os)
-    : observer_box_t(os), step_printer_(nullptr), is_step_mode_(arghs["step-"
-                                                                      "mode"]) {
-  if (is_step_mode_) step_printer_ = std::make_unique<step_printer>(arghs, os);
-  arghs("qumin", std::numeric_limits<double>::lowest()) >> qu_min_;
-  arghs("qumax", std::numeric_limits<double>::max()) >> qu_max_;
-  arghs("tfinal", 1) >> tfinal_;
-}
+q_predicate::q_predicate(const settings_t& settings, std::ostream& os)
+    : observer_box_t(os), is_step_mode_(settings.step_mode),
+      qu_min_(settings.qu_min), qu_max_(settings.qu_max),
+      tfinal_(settings.time_final),
+      step_printer_(
+          settings.step_mode
+              ? std::make_unique<step_printer>(settings.printer, os)
+              : nullptr) {}
@@ -33,7 +33,8 @@ initial position lies within bounds) and at the first time step after
 `time<tfinal` or after the gyron's position moves out of bounds.  Alternatively,
 the option `-step-mode` forces a `step_printer` observer to be built and invokes
 it at every time step within the requested bounds (all step_printer options
-apply).
+apply). Derived predicates (eg, `domain_predicate`) may restrict the bounds
+further by overriding `is_within_bounds()`.
 
 Observer options:
 
@@ -42,19 +43,28 @@ Observer options:
 !*/
 class q_predicate : public observer_box_t {
  public:
+  struct settings_t {
+    step_printer::settings_t printer;
+    double qu_min, qu_max, time_final;
+    bool step_mode;
+  };
+  static settings_t parse_settings(const argh::parser& arghs);
+  static settings_t parse_settings(
+      const argh::parser& arghs, const settings_t& base_settings);
   q_predicate() = delete;
-  q_predicate(const argh::parser& arghs, std::ostream& os);
+  q_predicate(const settings_t& settings, std::ostream& os);
   virtual ~q_predicate() {};
   virtual bool operator()(
       const pusher_box_t* pusher, double time) const override;
+ protected:
+  virtual bool is_within_bounds(const IR3& q) const;
  private:
   const bool is_step_mode_;
-  double qu_min_, qu_max_;
-  double tfinal_;
+  const double qu_min_, qu_max_;
+  const double tfinal_;
   std::unique_ptr<step_printer> step_printer_;
   bool invoke_step_mode(const pusher_box_t* pusher, double time) const;
   bool invoke_default(const pusher_box_t* pusher, double time) const;
-  bool is_within_bounds(const IR3& q) const;
   void print_last_state(const pusher_box_t* pusher, double time) const;
 };
 
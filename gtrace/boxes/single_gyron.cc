@@ -17,14 +17,81 @@
 // @boxes/single_gyron.cc, this file is part of gtrace.
 
 #include <gtrace/boxes/single_gyron.hh>
+#include <gtrace/tools/binary_io.hh>
 
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <sstream>
+
+std::string single_gyron::integrate_orbit(
+    pusher_box_t* pusher, const observer_box_t* observer, double tfinal,
+    bool* is_interrupted, double* elapsed) const {
+  std::string filename;
+  if (!(argh_line_("checkpoint") >> filename))
+    return driver_box_t::integrate_orbit(
+        pusher, observer, tfinal, is_interrupted, elapsed);
+  std::string state_signature = pusher->compose_state_signature();
+  double period;
+  argh_line_("checkpoint-period", tfinal / 16) >> period;
+  double time = 0;
+  bool is_resumed = argh_line_["resume"] && std::filesystem::exists(filename);
+  if (is_resumed) {
+    time = load_checkpoint(filename, state_signature, pusher);
+    std::cout << "# resumed from checkpoint at time: " << time << "\n";
+  }
+  auto tick_0 = std::chrono::steady_clock::now();
+  double next_checkpoint = time + period;
+  bool is_stopped = false, is_running = is_resumed || (*observer)(pusher, time);
+  for (size_t step = 1; is_running && time <= tfinal; step++) {
+    if (step % walltime_check_steps_ == 0 && this->is_out_of_time()) {
+      save_checkpoint(filename, state_signature, pusher, time);
+      is_stopped = true;
+      break;
+    }
+    time = pusher->push_state(time);
+    is_running = (*observer)(pusher, time);
+    if (time >= next_checkpoint) {
+      save_checkpoint(filename, state_signature, pusher, time);
+      next_checkpoint = time + period;
+    }
+  }
+  auto tick_1 = std::chrono::steady_clock::now();
+  if (is_interrupted) *is_interrupted = is_stopped;
+  double seconds = std::chrono::duration<double>(tick_1 - tick_0).count();
+  if (elapsed) *elapsed = seconds;
+  if (!is_stopped && argh_line_["peek-beyond-tfinal"])
+    (*observer)(pusher, time);
+  observer->flush();
+  std::ostringstream elapsed_time_line;
+  elapsed_time_line << "# elapsed time: "
+                    << std::chrono::duration<double>(tick_1 - tick_0);
+  return elapsed_time_line.str();
+}
+
+double single_gyron::load_checkpoint(
+    const std::string& filename, const std::string& state_signature,
+    pusher_box_t* pusher) {
+  std::ifstream is(filename, std::ios::binary);
+  char signature[sizeof(checkpoint_signature_)] = {};
+  if (!is.read(signature, sizeof(signature)) ||
+      std::string(signature) != checkpoint_signature_)
+    throw std::runtime_error("invalid checkpoint file " + filename + ".");
+  std::string saved_signature;
+  if (!std::getline(is, saved_signature) || saved_signature != state_signature)
+    throw std::runtime_error(
+        "checkpoint file " + filename + " is for another pusher or settings.");
+  double time;
+  read_binary(is, time);
+  pusher->load_state(is);
+  return time;
+}
 
 int single_gyron::operator()(int argc, char* argv[]) const {
   auto field = create_linked_field_box(argh_line_);
   auto pusher = create_linked_pusher_box(argh_line_, field.get());
-  auto observer = create_linked_observer_box(argh_line_, std::cout);
 
   std::cout << this->header_string(argc, argv) << "\n"
             << pusher->compose_output_fields() << "\n";
@@ -32,11 +99,34 @@ int single_gyron::operator()(int argc, char* argv[]) const {
     std::cout.precision(16);
     std::cout.setf(std::ios::scientific);
   }
+  auto observer = create_linked_observer_box(argh_line_, std::cout);
 
   double time_final;
   argh_line_("tfinal", 1) >> time_final;
-  std::string elapsed_time_info =
-      this->integrate_orbit(pusher.get(), observer.get(), time_final);
+  bool is_interrupted = false;
+  std::string elapsed_time_info = this->integrate_orbit(
+      pusher.get(), observer.get(), time_final, &is_interrupted);
   if (argh_line_["elapsed-time"]) std::cout << elapsed_time_info << "\n";
+  if (is_interrupted) std::cout << walltime_mark_ << "\n";
+  this->write_reductions(std::cout);
+  if (this->has_walltime()) {
+    walltime_tally_t tally;
+    (is_interrupted ? tally.interrupted : tally.completed)++;
+    std::cout << this->walltime_summary(tally) << "\n";
+  }
   return 0;
 }
+
+void single_gyron::save_checkpoint(
+    const std::string& filename, const std::string& state_signature,
+    const pusher_box_t* pusher, double time) {
+  std::string temporary_filename = filename + ".tmp";
+  std::ofstream os(temporary_filename, std::ios::binary | std::ios::trunc);
+  os.write(checkpoint_signature_, sizeof(checkpoint_signature_));
+  os << state_signature << "\n";
+  write_binary(os, time);
+  pusher->save_state(os);
+  os.close();
+  if (!os) throw std::runtime_error("cannot write to " + temporary_filename);
+  std::filesystem::rename(temporary_filename, filename);
+}
@@ -31,9 +31,29 @@ gyron to be traced is defined by the state type of the invoked `pusher_box_t`.
 Any output produced by the required `observer_box_t` is redirected to
 `std::cout`.
 
+With `-checkpoint=file`, the full integration state of the pusher (including the
+history of multistep methods) is saved every `-checkpoint-period` time units,
+written first to `file.tmp` and then renamed over `file`, so that a crash never
+leaves a damaged checkpoint behind. Adding `-resume` restarts the integration
+from the state and time stored in `file` (if it exists), producing the very same
+orbit as an uninterrupted run. Checkpoints hold states already passed to the
+observer, which is not called again at the resumed time, thus the output of the
+resumed run continues that of the original one without repeating any row.
+Observers are not checkpointed, though, and any internal counters they hold (eg,
+`-skip`) restart with the run. The pusher and the remaining options must be the
+same as in the original run: the checkpoint stores the pusher's
+`compose_state_signature()` (its type, time step, etc), and resuming with a
+different one throws. Pushers unable to checkpoint their state throw as well,
+before the integration starts. An orbit interrupted by `-walltime` (see
+`driver_box_t`) is checkpointed at the interruption time, so that `-resume`
+continues it in the next job.
+
 Driver options:
 
+ + `-checkpoint=file` Saves checkpoints to `file` (default none).
+ + `-checkpoint-period=val` Time between checkpoints (default `tfinal/16`).
  + `-elapsed` Prints the elapsed time for each orbit (defaults to no print).
+ + `-resume` Resumes the integration from the last checkpoint.
  + `-sci-16` Turns on 16-digit scientific format for numeric output.
  + `-tfinal=val` Time-integration limit (default 1, in `pusher_box_t` units).
 !*/
@@ -42,6 +62,17 @@ class single_gyron : public driver_box_t {
   single_gyron(int argc, char* argv[]) : driver_box_t(argc, argv) {};
   virtual ~single_gyron() {};
   virtual int operator()(int argc, char* argv[]) const;
+  virtual std::string integrate_orbit(
+      pusher_box_t* pusher, const observer_box_t* observer, double tfinal,
+      bool* is_interrupted = nullptr, double* elapsed = nullptr) const override;
+ private:
+  static constexpr char checkpoint_signature_[] = "GTRACECK";
+  static double load_checkpoint(
+      const std::string& filename, const std::string& state_signature,
+      pusher_box_t* pusher);
+  static void save_checkpoint(
+      const std::string& filename, const std::string& state_signature,
+      const pusher_box_t* pusher, double time);
 };
 
 #endif  // GTRACE_SINGLE_GYRON
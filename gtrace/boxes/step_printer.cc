@@ -17,21 +17,34 @@
 // @boxes/step_printer.cc, this file is part of gtrace.
 
 #include <gtrace/boxes/step_printer.hh>
+#include <gtrace/tools/layered_arghs.hh>
+#include <gtrace/tools/text_record.hh>
 
 #include <iostream>
 
-step_printer::step_printer(const argh::parser& arghs, std::ostream& os)
-    : observer_box_t(os) {
-  arghs("skip", 0) >> skip_;
-  skipped_steps_ = (arghs["skip-initial"] ? 0 : skip_);
-}
+step_printer::step_printer(const settings_t& settings, std::ostream& os)
+    : observer_box_t(os), skip_(settings.skip),
+      skipped_steps_(settings.skip_initial ? 0 : settings.skip) {}
 
 bool step_printer::operator()(const pusher_box_t* pusher, double time) const {
   if (skipped_steps_ < skip_) skipped_steps_++;
   else {
-    for (auto x : pusher->compose_output_values(time)) ostream_ << x << " ";
-    ostream_ << "\n";
+    text_record::write(ostream_, pusher->compose_output_values(time));
     skipped_steps_ = 0;
   }
   return true;
 }
+
+step_printer::settings_t step_printer::parse_settings(
+    const argh::parser& arghs) {
+  return parse_settings(arghs, {.skip = 0, .skip_initial = false});
+}
+
+step_printer::settings_t step_printer::parse_settings(
+    const argh::parser& arghs, const settings_t& base) {
+  settings_t settings = base;
+  arghs("skip", base.skip) >> settings.skip;
+  settings.skip_initial =
+      layered_flag(arghs, "skip-initial", base.skip_initial);
+  return settings;
+}
@@ -28,7 +28,8 @@ Sequential integration-step printer.
 Calls the virtual function `pusher->print_state(time)`, as implemented by the
 particular `pusher_box_t` invoked, sequentially throughout the entire
 integration process (provides no termination condition by itself), eventually
-skipping skip time steps.
+skipping skip time steps. Each record is formatted in a single pass by
+`text_record::write()`, in the format set on the output stream.
 
 Observer options:
 
@@ -37,13 +38,20 @@ Observer options:
 !*/
 class step_printer : public observer_box_t {
  public:
+  struct settings_t {
+    size_t skip;
+    bool skip_initial;
+  };
+  static settings_t parse_settings(const argh::parser& arghs);
+  static settings_t parse_settings(
+      const argh::parser& arghs, const settings_t& base_settings);
   step_printer() = delete;
-  step_printer(const argh::parser& arghs, std::ostream& os);
+  step_printer(const settings_t& settings, std::ostream& os);
   virtual ~step_printer() {};
   virtual bool operator()(
       const pusher_box_t* pusher, double time) const override;
  private:
-  size_t skip_;
+  const size_t skip_;
   mutable size_t skipped_steps_;
 };
 
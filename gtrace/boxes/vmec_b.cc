@@ -16,18 +16,46 @@
 
 // @boxes/vmec_b.cc, this file is part of gtrace.
 
+#include <gyronimo/core/dblock.hh>
 #include <gyronimo/fields/IR3field_c1_cache.hh>
 #include <gyronimo/metrics/metric_cache.hh>
 #include <gyronimo/metrics/morphism_cache.hh>
 
 #include <gtrace/boxes/vmec_b.hh>
 
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <valarray>
+
 const IR3field* vmec_b::get_magnetic_field() const {
   return magnetic_field_.get();
 }
 const metric_covariant* vmec_b::get_metric() const { return metric_.get(); }
 
-vmec_b::vmec_b(const argh::parser& arghs) : ifactory_(new cubic_gsl_factory()) {
+double vmec_b::get_poloidal_flux(const IR3& q, double time) const {
+  if (!poloidal_flux_) return field_box_t::get_poloidal_flux(q, time);
+  return (*poloidal_flux_)(q[IR3::u]);
+}
+
+void vmec_b::magnetic_magnitudes(
+    std::span<const IR3> positions, double,
+    std::span<double> magnitudes) const {
+  std::fill(magnitudes.begin(), magnitudes.end(), 0.0);
+  for (size_t m = 0; m < bmnc_.size(); m++) {
+    const interpolator1d& bmnc = *bmnc_[m];
+    for (size_t i = 0; i < positions.size(); i++) {
+      const IR3& q = positions[i];
+      double angle = xm_nyq_[m] * q[IR3::v] - xn_nyq_[m] * q[IR3::w];
+      magnitudes[i] += bmnc(q[IR3::u]) * std::cos(angle);
+    }
+  }
+  double m_factor = magnetic_field_->m_factor();
+  for (double& magnitude : magnitudes) magnitude /= m_factor;
+}
+
+vmec_b::vmec_b(const argh::parser& arghs)
+    : is_cached_(arghs["cached"]), ifactory_(new cubic_gsl_factory()) {
   std::string vmec_filename;
   arghs("vmec-file", "") >> vmec_filename;
   parser_ = std::make_unique<parser_vmec>(vmec_filename);
@@ -39,7 +67,7 @@ vmec_b::vmec_b(const argh::parser& arghs) : ifactory_(new cubic_gsl_factory()) {
   arghs("abstol", 1e-12) >> settings.tolerance_abs;
   arghs("reltol", 1e-12) >> settings.tolerance_rel;
 
-  if (arghs["cached"]) {
+  if (is_cached_) {
     using gyronimo::IR3field_c1_cache;
     using gyronimo::metric_cache, gyronimo::morphism_cache;
     morphism_ = std::make_unique<morphism_cache<morphism_vmec>>(
@@ -54,4 +82,27 @@ vmec_b::vmec_b(const argh::parser& arghs) : ifactory_(new cubic_gsl_factory()) {
     magnetic_field_ =
         std::make_unique<equilibrium_vmec>(metric_.get(), ifactory_.get());
   }
+
+  const auto& xm_nyq = parser_->xm_nyq();
+  const auto& xn_nyq = parser_->xn_nyq();
+  xm_nyq_.assign(std::begin(xm_nyq), std::end(xm_nyq));
+  xn_nyq_.assign(std::begin(xn_nyq), std::end(xn_nyq));
+  gyronimo::dblock_adapter s_range(parser_->radius());
+  for (size_t m = 0; m < xm_nyq_.size(); m++) {
+    std::valarray<double> bmnc_m =
+        parser_->bmnc()[std::slice(m, s_range.size(), xm_nyq_.size())];
+    bmnc_.emplace_back(ifactory_->interpolate_data(
+        s_range, gyronimo::dblock_adapter(bmnc_m)));
+  }
+  if (parser_->ntor() == 0) {
+    const auto& phi = parser_->phi();
+    const auto& iota = parser_->iotaf();
+    std::valarray<double> flux(0.0, phi.size());
+    for (size_t k = 1; k < phi.size(); k++) {
+      double dphi = (phi[k] - phi[k - 1]) / (2 * std::numbers::pi);
+      flux[k] = flux[k - 1] + 0.5 * (iota[k] + iota[k - 1]) * dphi;
+    }
+    poloidal_flux_.reset(ifactory_->interpolate_data(
+        s_range, gyronimo::dblock_adapter(flux)));
+  }
 }
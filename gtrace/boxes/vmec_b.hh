@@ -24,8 +24,11 @@
 
 #include <gtrace/boxes/field_box.hh>
 
+#include <vector>
+
 using gyronimo::cubic_gsl_factory;
 using gyronimo::equilibrium_vmec;
+using gyronimo::interpolator1d;
 using gyronimo::metric_vmec;
 using gyronimo::morphism_vmec;
 using gyronimo::parser_vmec;
@@ -36,7 +39,13 @@ Magnetic field by the mhd-equilibrium code VMEC.
 
 Sets a `gyronimo::equilibrium_vmec` object (and its dependencies) by reading a
 netcdf file produced by the mhd-equilibrium code
-[VMEC](https://princetonuniversity.github.io/STELLOPT/VMEC.html).
+[VMEC](https://princetonuniversity.github.io/STELLOPT/VMEC.html). Batched
+queries of `magnetic_magnitudes()` sum the Fourier series of $|B|$ one mode at
+a time over all positions, so each mode's radial spline is brought into cache
+once per batch and the inner loop runs over contiguous positions. Equilibria
+without toroidal modes (ie, `ntor` zero) are axisymmetric (see `field_box_t`),
+their poloidal flux being integrated from the rotational transform over the
+toroidal flux and interpolated radially.
 
 Field options:
 
@@ -44,7 +53,7 @@ Field options:
     Builds a level-1 cached version of the objects `gyronimo::{equilibrium_vmec,
     metric_vmec, morphism_vmec}`. Eventual performance improvements depend
     heavily on how particular pushers call this field and cannot be assumed a
-    priori.
+    priori. The caches are not thread safe (see `field_box_t`).
 
  + `-vmec-file=val` Path to the netcdf file produced by VMEC.
 
@@ -65,12 +74,24 @@ class vmec_b : public field_box_t {
   };
   virtual const IR3field* get_magnetic_field() const override;
   virtual const metric_covariant* get_metric() const override;
+  virtual bool is_thread_safe() const override { return !is_cached_; };
+  virtual bool is_axisymmetric() const override {
+    return (bool)poloidal_flux_;
+  };
+  virtual double get_poloidal_flux(const IR3& q, double time) const override;
+  virtual void magnetic_magnitudes(
+      std::span<const IR3> positions, double time,
+      std::span<double> magnitudes) const override;
  private:
+  const bool is_cached_;
   std::unique_ptr<cubic_gsl_factory> ifactory_;
   std::unique_ptr<parser_vmec> parser_;
   std::unique_ptr<morphism_vmec> morphism_;
   std::unique_ptr<metric_vmec> metric_;
   std::unique_ptr<equilibrium_vmec> magnetic_field_;
+  std::vector<std::unique_ptr<interpolator1d>> bmnc_;
+  std::unique_ptr<interpolator1d> poloidal_flux_;
+  std::vector<double> xm_nyq_, xn_nyq_;
 };
 
 #endif  // GTRACE_VMEC_B
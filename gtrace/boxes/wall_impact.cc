@@ -0,0 +1,85 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/wall_impact.cc, this file is part of gtrace.
+
+#include <gyronimo/metrics/metric_connected.hh>
+
+#include <gtrace/boxes/wall_impact.hh>
+#include <gtrace/tools/text_record.hh>
+
+#include <map>
+#include <mutex>
+
+wall_impact::wall_impact(const settings_t& settings, std::ostream& os)
+    : observer_box_t(os), mesh_(settings.mesh) {}
+
+void wall_impact::flush() const { is_started_ = false; }
+
+bool wall_impact::operator()(const pusher_box_t* pusher, double time) const {
+  if (!morphism_) {
+    auto g = dynamic_cast<const gyronimo::metric_connected*>(
+        pusher->field_box()->get_metric());
+    if (!g)
+      throw std::runtime_error("wall_impact: needs a connected metric.");
+    morphism_ = g->my_morphism();
+  }
+  IR3 x = (*morphism_)(pusher->get_q(time));
+  wall_mesh::point_t point = {x[0], x[1], x[2]};
+  auto hit = (is_started_ ? mesh_->intersect(point_, point) : std::nullopt);
+  double previous_time = time_;
+  is_started_ = true, time_ = time, point_ = point;
+  if (!hit) return true;
+  ostream_ << "# impact: t x y z triangle energy weight\n";
+  text_record::write(
+      ostream_, {previous_time + hit->fraction * (time - previous_time),
+                 hit->point[0], hit->point[1], hit->point[2],
+                 (double)hit->triangle, pusher->get_energy(time),
+                 pusher->get_weight()});
+  return false;
+}
+
+wall_impact::settings_t wall_impact::parse_settings(const argh::parser& arghs) {
+  settings_t settings =
+      parse_settings(arghs, {.filename = "", .scale = 1, .mesh = nullptr});
+  if (!settings.mesh)
+    throw std::invalid_argument("wall_impact: missing -wall-mesh.");
+  return settings;
+}
+
+wall_impact::settings_t wall_impact::parse_settings(
+    const argh::parser& arghs, const settings_t& base) {
+  settings_t settings = base;
+  arghs("wall-mesh", base.filename) >> settings.filename;
+  arghs("wall-scale", base.scale) >> settings.scale;
+  if (!settings.filename.empty() &&
+      (!base.mesh || settings.filename != base.filename ||
+       settings.scale != base.scale))
+    settings.mesh = shared_mesh(settings.filename, settings.scale);
+  return settings;
+}
+
+std::shared_ptr<const wall_mesh> wall_impact::shared_mesh(
+    const std::string& filename, double scale) {
+  static std::mutex mutex;
+  static std::map<
+      std::pair<std::string, double>, std::shared_ptr<const wall_mesh>>
+      meshes;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& mesh = meshes[{filename, scale}];
+  if (!mesh) mesh = std::make_shared<const wall_mesh>(filename, scale);
+  return mesh;
+}
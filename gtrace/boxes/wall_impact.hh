@@ -0,0 +1,79 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @boxes/wall_impact.hh, this file is part of gtrace.
+
+#ifndef GTRACE_WALL_IMPACT
+#define GTRACE_WALL_IMPACT
+
+#include <gyronimo/metrics/morphism.hh>
+
+#include <gtrace/boxes/observer_box.hh>
+#include <gtrace/tools/wall_mesh.hh>
+
+#include <memory>
+#include <string>
+
+/*!
+Stops the time integration where the orbit hits a triangulated first wall.
+--------------------------------------------------------------------------
+
+Maps the gyron's position at each step to Cartesian coordinates (by the
+morphism of the field's metric, which must be connected) and intersects the
+segment travelled since the previous step with the wall mesh read from
+`-wall-mesh` (STL or OBJ, see `wall_mesh`). At the first crossing, the orbit
+is stopped and a single row is written, preceded by the line `# impact:`
+naming its columns: the impact time (interpolated linearly along the step),
+the Cartesian impact point, the index of the triangle hit (in the order of the
+file), and the gyron's energy (eV) and weight, from which wall loads follow by
+accumulating rows over triangles. Orbits never hitting the wall write nothing.
+The mesh and its bounding-volume hierarchy are built once per process, when the
+options naming it are first parsed (see `observer_builder_t`), and shared by all
+later observers and threads, so that each step costs a handful of box tests even
+for millions of triangles.
+
+Observer options:
+
+ + `-wall-mesh=file` Wall mesh, either `.stl` (binary or ascii) or `.obj`.
+ + `-wall-scale=val` Factor converting the mesh coordinates to SI (default 1).
+!*/
+class wall_impact : public observer_box_t {
+ public:
+  struct settings_t {
+    std::string filename;
+    double scale;
+    std::shared_ptr<const wall_mesh> mesh;
+  };
+  static settings_t parse_settings(const argh::parser& arghs);
+  static settings_t parse_settings(
+      const argh::parser& arghs, const settings_t& base_settings);
+  wall_impact() = delete;
+  wall_impact(const settings_t& settings, std::ostream& os);
+  virtual ~wall_impact() {};
+  virtual bool operator()(
+      const pusher_box_t* pusher, double time) const override;
+  virtual void flush() const override;
+ private:
+  const std::shared_ptr<const wall_mesh> mesh_;
+  mutable const gyronimo::morphism* morphism_ = nullptr;
+  mutable bool is_started_ = false;
+  mutable double time_;
+  mutable wall_mesh::point_t point_;
+  static std::shared_ptr<const wall_mesh> shared_mesh(
+      const std::string& filename, double scale);
+};
+
+#endif  // GTRACE_WALL_IMPACT
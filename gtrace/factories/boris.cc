@@ -25,3 +25,9 @@ std::unique_ptr<pusher_box_t> create_linked_pusher_box(
   boris::settings_t settings = boris::parse_settings(arghs);
   return std::move(std::make_unique<boris>(settings, field_box));
 }
+
+std::unique_ptr<pusher_builder_t> create_linked_pusher_builder(
+    const argh::parser& shared_arghs) {
+  return std::move(
+      std::make_unique<layered_pusher_builder<boris>>(shared_arghs));
+}
@@ -0,0 +1,33 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @factories/domain_predicate.cc, this file is part of gtrace.
+
+#include <gtrace/boxes/domain_predicate.hh>
+
+std::unique_ptr<observer_box_t> create_linked_observer_box(
+    const argh::parser& arghs, std::ostream& os) {
+  domain_predicate::settings_t settings =
+      domain_predicate::parse_settings(arghs);
+  return std::move(std::make_unique<domain_predicate>(settings, os));
+}
+
+std::unique_ptr<observer_builder_t> create_linked_observer_builder(
+    const argh::parser& shared_arghs) {
+  return std::move(
+      std::make_unique<layered_observer_builder<domain_predicate>>(
+          shared_arghs));
+}
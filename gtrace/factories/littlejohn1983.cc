@@ -25,3 +25,9 @@ std::unique_ptr<pusher_box_t> create_linked_pusher_box(
   littlejohn1983::settings_t settings = littlejohn1983::parse_settings(arghs);
   return std::move(std::make_unique<littlejohn1983>(settings, field_box));
 }
+
+std::unique_ptr<pusher_builder_t> create_linked_pusher_builder(
+    const argh::parser& shared_arghs) {
+  return std::move(
+      std::make_unique<layered_pusher_builder<littlejohn1983>>(shared_arghs));
+}
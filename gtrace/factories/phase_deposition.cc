@@ -0,0 +1,37 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @factories/phase_deposition.cc, this file is part of gtrace.
+
+#include <gtrace/boxes/phase_deposition.hh>
+
+std::unique_ptr<observer_box_t> create_linked_observer_box(
+    const argh::parser& arghs, std::ostream& os) {
+  phase_deposition::settings_t settings =
+      phase_deposition::parse_settings(arghs);
+  return std::move(std::make_unique<phase_deposition>(settings, os));
+}
+
+std::unique_ptr<observer_builder_t> create_linked_observer_builder(
+    const argh::parser& shared_arghs) {
+  return std::move(
+      std::make_unique<layered_observer_builder<phase_deposition>>(
+          shared_arghs));
+}
+
+void register_linked_reductions(const argh::parser& arghs) {
+  phase_deposition::local_grid(phase_deposition::parse_settings(arghs));
+}
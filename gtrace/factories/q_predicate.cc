@@ -20,5 +20,12 @@
 
 std::unique_ptr<observer_box_t> create_linked_observer_box(
     const argh::parser& arghs, std::ostream& os) {
-  return std::move(std::make_unique<q_predicate>(arghs, os));
+  q_predicate::settings_t settings = q_predicate::parse_settings(arghs);
+  return std::move(std::make_unique<q_predicate>(settings, os));
+}
+
+std::unique_ptr<observer_builder_t> create_linked_observer_builder(
+    const argh::parser& shared_arghs) {
+  return std::move(
+      std::make_unique<layered_observer_builder<q_predicate>>(shared_arghs));
 }
@@ -20,5 +20,12 @@
 
 std::unique_ptr<observer_box_t> create_linked_observer_box(
     const argh::parser& arghs, std::ostream& os) {
-  return std::move(std::make_unique<step_printer>(arghs, os));
+  step_printer::settings_t settings = step_printer::parse_settings(arghs);
+  return std::move(std::make_unique<step_printer>(settings, os));
+}
+
+std::unique_ptr<observer_builder_t> create_linked_observer_builder(
+    const argh::parser& shared_arghs) {
+  return std::move(
+      std::make_unique<layered_observer_builder<step_printer>>(shared_arghs));
 }
@@ -0,0 +1,46 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/binary_io.hh, this file is part of gtrace.
+
+#ifndef GTRACE_BINARY_IO
+#define GTRACE_BINARY_IO
+
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+/*!
+Raw (native-endian) i/o of trivially-copyable objects.
+------------------------------------------------------
+
+Used to store integration states exactly, bit by bit, as required to resume an
+interrupted orbit from a checkpoint with no loss of precision. `read_binary()`
+throws if the stream ends before the whole object is read.
+!*/
+template<typename T> void write_binary(std::ostream& os, const T& x) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  os.write(reinterpret_cast<const char*>(&x), sizeof(T));
+}
+
+template<typename T> void read_binary(std::istream& is, T& x) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  if (!is.read(reinterpret_cast<char*>(&x), sizeof(T)))
+    throw std::runtime_error("truncated binary stream.");
+}
+
+#endif  // GTRACE_BINARY_IO
@@ -0,0 +1,113 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/boundary_table.hh, this file is part of gtrace.
+
+#ifndef GTRACE_BOUNDARY_TABLE
+#define GTRACE_BOUNDARY_TABLE
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*!
+Boundary surface `qu = s_b(qv, qw)`, tabulated over the two angles.
+--------------------------------------------------------------------
+
+Holds the values of `s_b` at the nodes of a regular `nv` x `nw` grid spanning
+one period of each angle (`period_v` and `period_w`, eg, $2\pi$ and $2\pi$
+over the number of field periods), and evaluates it anywhere by periodic
+bilinear interpolation, at the cost of a few arithmetic operations and four
+table reads. Tables are built either by `sample()`, evaluating a function
+`s_b(v, w)` once per node (eg, a root search of some boundary along `qu`), or
+by `read()`, from a text file holding `nv` and `nw` followed by the `nv*nw`
+node values, with `qw` running fastest.
+!*/
+class boundary_table {
+ public:
+  boundary_table(
+      size_t nv, size_t nw, double period_v, double period_w,
+      std::vector<double>&& nodes);
+  double operator()(double v, double w) const;
+  static boundary_table read(
+      const std::string& filename, double period_v, double period_w);
+  template<typename Function>
+  static boundary_table sample(
+      size_t nv, size_t nw, double period_v, double period_w,
+      Function&& s_b);
+ private:
+  const size_t nv_, nw_;
+  const double turns_v_, turns_w_;
+  const std::vector<double> nodes_;
+  static void locate(double turns, size_t n, size_t& i, double& fraction);
+};
+
+inline boundary_table::boundary_table(
+    size_t nv, size_t nw, double period_v, double period_w,
+    std::vector<double>&& nodes)
+    : nv_(nv), nw_(nw), turns_v_(1 / period_v), turns_w_(1 / period_w),
+      nodes_(std::move(nodes)) {
+  if (nv == 0 || nw == 0 || nodes_.size() != nv * nw)
+    throw std::invalid_argument("inconsistent boundary_table size.");
+}
+
+inline void boundary_table::locate(
+    double turns, size_t n, size_t& i, double& fraction) {
+  double x = n * (turns - std::floor(turns));
+  i = std::min<size_t>(x, n - 1);
+  fraction = x - i;
+}
+
+inline double boundary_table::operator()(double v, double w) const {
+  size_t i, j;
+  double fv, fw;
+  locate(v * turns_v_, nv_, i, fv);
+  locate(w * turns_w_, nw_, j, fw);
+  size_t i1 = (i + 1 == nv_ ? 0 : i + 1), j1 = (j + 1 == nw_ ? 0 : j + 1);
+  const double* row_0 = nodes_.data() + i * nw_;
+  const double* row_1 = nodes_.data() + i1 * nw_;
+  double s_0 = row_0[j] + fw * (row_0[j1] - row_0[j]);
+  double s_1 = row_1[j] + fw * (row_1[j1] - row_1[j]);
+  return s_0 + fv * (s_1 - s_0);
+}
+
+inline boundary_table boundary_table::read(
+    const std::string& filename, double period_v, double period_w) {
+  std::ifstream in_stream(filename);
+  size_t nv = 0, nw = 0;
+  in_stream >> nv >> nw;
+  std::vector<double> nodes(nv * nw);
+  for (double& node : nodes) in_stream >> node;
+  if (!in_stream)
+    throw std::runtime_error("cannot read boundary from file " + filename);
+  return boundary_table(nv, nw, period_v, period_w, std::move(nodes));
+}
+
+template<typename Function>
+boundary_table boundary_table::sample(
+    size_t nv, size_t nw, double period_v, double period_w, Function&& s_b) {
+  std::vector<double> nodes;
+  nodes.reserve(nv * nw);
+  for (size_t i = 0; i < nv; i++)
+    for (size_t j = 0; j < nw; j++)
+      nodes.push_back(s_b(i * period_v / nv, j * period_w / nw));
+  return boundary_table(nv, nw, period_v, period_w, std::move(nodes));
+}
+
+#endif  // GTRACE_BOUNDARY_TABLE
@@ -0,0 +1,77 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/bounded_queue.hh, this file is part of gtrace.
+
+#ifndef GTRACE_BOUNDED_QUEUE
+#define GTRACE_BOUNDED_QUEUE
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+
+/*!
+Blocking fifo queue with bounded capacity, linking stages of a pipeline.
+------------------------------------------------------------------------
+
+`push()` blocks while the queue is full (backpressure on the producers) and
+`pop()` blocks while it is empty. Once `close()` is called, producers can no
+longer push and `pop()` returns an empty optional after the remaining items are
+drained, signalling consumers to stop.
+!*/
+template<typename T> class bounded_queue {
+ public:
+  bounded_queue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {};
+  void close();
+  std::optional<T> pop();
+  void push(T&& item);
+ private:
+  const size_t capacity_;
+  bool is_closed_ = false;
+  std::deque<T> items_;
+  std::mutex mutex_;
+  std::condition_variable not_empty_, not_full_;
+};
+
+template<typename T> void bounded_queue<T>::close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  is_closed_ = true;
+  not_empty_.notify_all();
+  not_full_.notify_all();
+}
+
+template<typename T> std::optional<T> bounded_queue<T>::pop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  not_empty_.wait(lock, [this] { return is_closed_ || !items_.empty(); });
+  if (items_.empty()) return std::nullopt;
+  T item = std::move(items_.front());
+  items_.pop_front();
+  not_full_.notify_one();
+  return item;
+}
+
+template<typename T> void bounded_queue<T>::push(T&& item) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  not_full_.wait(
+      lock, [this] { return is_closed_ || items_.size() < capacity_; });
+  if (is_closed_) throw std::logic_error("push into a closed bounded_queue.");
+  items_.push_back(std::move(item));
+  not_empty_.notify_one();
+}
+
+#endif  // GTRACE_BOUNDED_QUEUE
@@ -0,0 +1,75 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/chunked_streambuf.hh, this file is part of gtrace.
+
+#ifndef GTRACE_CHUNKED_STREAMBUF
+#define GTRACE_CHUNKED_STREAMBUF
+
+#include <functional>
+#include <streambuf>
+#include <string>
+
+/*!
+Stream buffer handing its output over in chunks of bounded size.
+----------------------------------------------------------------
+
+Collects the characters written into an `std::ostream` on top of it and, each
+time `chunk_size` of them are gathered (or `flush_chunk()` is called), moves
+them as a single string into the supplied sink function. The memory held by the
+stream thus never exceeds one chunk, however long the output.
+!*/
+class chunked_streambuf : public std::streambuf {
+ public:
+  using sink_t = std::function<void(std::string&&)>;
+  chunked_streambuf(size_t chunk_size, sink_t sink);
+  void flush_chunk();
+ protected:
+  virtual int_type overflow(int_type c) override;
+ private:
+  const size_t chunk_size_;
+  const sink_t sink_;
+  std::string chunk_;
+  void reset_chunk();
+};
+
+inline chunked_streambuf::chunked_streambuf(size_t chunk_size, sink_t sink)
+    : chunk_size_(chunk_size > 0 ? chunk_size : 1), sink_(sink) {
+  this->reset_chunk();
+}
+
+inline void chunked_streambuf::flush_chunk() {
+  if (pptr() == pbase()) return;
+  chunk_.resize(pptr() - pbase());
+  sink_(std::move(chunk_));
+  this->reset_chunk();
+}
+
+inline chunked_streambuf::int_type chunked_streambuf::overflow(int_type c) {
+  this->flush_chunk();
+  if (traits_type::eq_int_type(c, traits_type::eof()))
+    return traits_type::not_eof(c);
+  *pptr() = traits_type::to_char_type(c);
+  pbump(1);
+  return c;
+}
+
+inline void chunked_streambuf::reset_chunk() {
+  chunk_.assign(chunk_size_, '\0');
+  setp(chunk_.data(), chunk_.data() + chunk_.size());
+}
+
+#endif  // GTRACE_CHUNKED_STREAMBUF
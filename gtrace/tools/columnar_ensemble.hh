@@ -0,0 +1,110 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/columnar_ensemble.hh, this file is part of gtrace.
+
+#ifndef GTRACE_COLUMNAR_ENSEMBLE
+#define GTRACE_COLUMNAR_ENSEMBLE
+
+#include <gtrace/boxes/pusher_box.hh>
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*!
+Memory-mapped binary file of ensemble initial conditions.
+---------------------------------------------------------
+
+The file starts with the 8-byte magic string `GTRACEIC` followed by the number
+`n` of gyrons (`uint64_t`) and then by eight contiguous columns of `n` doubles
+each, in the order of the members of `gyron_ic_t` (ie, qu, qv, qw, energy,
+pitch, gyrophase, weight, id). All values are stored in the native byte order
+of the machine. The file is mapped read-only into memory and each gyron's
+initial condition is assembled directly from the columns, no text parsing
+involved (`gyron_ic_header()` composes the comment line identifying each
+gyron's output block in the ensemble drivers). A file with `n` gyrons is, eg,
+written from python by
+
+    open(name, "wb").write(b"GTRACEIC" + numpy.uint64(n).tobytes() +
+        numpy.stack([qu, qv, qw, energy, pitch, gyrophase, weight, id])
+        .astype(numpy.float64).tobytes())
+!*/
+class columnar_ensemble {
+ public:
+  columnar_ensemble(const std::string& filename);
+  ~columnar_ensemble() { munmap(data_, n_bytes_); };
+  columnar_ensemble(const columnar_ensemble&) = delete;
+  columnar_ensemble& operator=(const columnar_ensemble&) = delete;
+  size_t size() const { return size_; };
+  gyron_ic_t operator[](size_t i) const;
+ private:
+  static constexpr char magic_[] = "GTRACEIC";
+  static constexpr size_t header_bytes_ = 8 + sizeof(uint64_t);
+  static constexpr size_t n_columns_ = sizeof(gyron_ic_t) / sizeof(double);
+  void* data_;
+  size_t n_bytes_, size_;
+  const double* columns_;
+};
+
+inline columnar_ensemble::columnar_ensemble(const std::string& filename) {
+  int descriptor = open(filename.c_str(), O_RDONLY);
+  struct stat file_status;
+  if (descriptor < 0 || fstat(descriptor, &file_status) != 0)
+    throw std::runtime_error("cannot read from file " + filename + ".\n");
+  n_bytes_ = file_status.st_size;
+  data_ =
+      (n_bytes_ < header_bytes_
+           ? MAP_FAILED
+           : mmap(nullptr, n_bytes_, PROT_READ, MAP_PRIVATE, descriptor, 0));
+  close(descriptor);
+  if (data_ == MAP_FAILED)
+    throw std::runtime_error("cannot map file " + filename + ".\n");
+  const char* bytes = static_cast<const char*>(data_);
+  uint64_t size;
+  std::memcpy(&size, bytes + 8, sizeof(size));
+  size_ = size;
+  if (std::memcmp(bytes, magic_, 8) != 0 ||
+      n_bytes_ != header_bytes_ + n_columns_ * size_ * sizeof(double)) {
+    munmap(data_, n_bytes_);
+    throw std::runtime_error("malformed ensemble file " + filename + ".\n");
+  }
+  columns_ = reinterpret_cast<const double*>(bytes + header_bytes_);
+}
+
+inline gyron_ic_t columnar_ensemble::operator[](size_t i) const {
+  const double* column = columns_ + i;
+  return {
+      .qu = column[0], .qv = column[size_], .qw = column[2 * size_],
+      .energy = column[3 * size_], .pitch = column[4 * size_],
+      .gyrophase = column[5 * size_], .weight = column[6 * size_],
+      .id = column[7 * size_]};
+}
+
+inline std::string gyron_ic_header(const gyron_ic_t& ic) {
+  std::ostringstream header;
+  header << "# gyron id: " << (uint64_t)ic.id << ", weight: " << ic.weight;
+  return header.str();
+}
+
+#endif  // GTRACE_COLUMNAR_ENSEMBLE
@@ -0,0 +1,161 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/completion_journal.hh, this file is part of gtrace.
+
+#ifndef GTRACE_COMPLETION_JOURNAL
+#define GTRACE_COMPLETION_JOURNAL
+
+#include <fstream>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/*!
+Append-only journal of completed gyrons, for resumable ensemble runs.
+---------------------------------------------------------------------
+
+Each record holds the id of a completed gyron and its whole output block,
+preceded by the header line `@gtrace-journal id nbytes`. Records are appended
+with a single `write()` and synced to disk before `commit()` returns, thus a
+crash can only leave an incomplete record at the end of the file, which is
+discarded (truncated) when the journal is reopened. The ids of the records
+found at reopening (and, optionally, those of other journals, eg written by
+other processes) form the set of completed gyrons to be skipped by a restarted
+run, while `replay()` copies their outputs to an output stream. Gyron ids are
+arbitrary strings without blanks.
+
+Parallel drivers keep one journal per process, named `prefix-nnn.journal` with
+`nnn` the process rank, opened by `open_rank_journal()`: the completed ids of
+all existing journals are loaded (the process count may change between runs),
+the own journal is replayed into the output stream and, by rank 0 only, so are
+the journals left by ranks no longer running.
+!*/
+class completion_journal {
+ public:
+  completion_journal(const std::string& filename);
+  ~completion_journal() { close(descriptor_); };
+  completion_journal(const completion_journal&) = delete;
+  completion_journal& operator=(const completion_journal&) = delete;
+  void commit(const std::string& id, const std::string& output);
+  bool is_completed(const std::string& id) const;
+  void load_completed_ids(const std::string& filename);
+  static std::unique_ptr<completion_journal> open_rank_journal(
+      const std::string& prefix, int rank, int size, std::ostream& os);
+  static void replay(const std::string& filename, std::ostream& os);
+ private:
+  using record_handler_t =
+      std::function<void(const std::string&, std::istream&, size_t)>;
+  const std::string filename_;
+  int descriptor_;
+  std::mutex mutex_;
+  std::unordered_set<std::string> completed_ids_;
+  static size_t scan(const std::string& filename, record_handler_t handler);
+};
+
+inline completion_journal::completion_journal(const std::string& filename)
+    : filename_(filename) {
+  size_t valid_length = this->scan(
+      filename_, [this](const std::string& id, std::istream& is, size_t n) {
+        completed_ids_.insert(id);
+        is.ignore(n);
+      });
+  descriptor_ = open(filename_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (descriptor_ < 0 || ftruncate(descriptor_, valid_length) != 0)
+    throw std::runtime_error("cannot write to file " + filename_ + ".\n");
+}
+
+inline void completion_journal::commit(
+    const std::string& id, const std::string& output) {
+  std::string record = "@gtrace-journal " + id + " " +
+                       std::to_string(output.size()) + "\n" + output;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t written = 0; written < record.size();) {
+    ssize_t n = write(
+        descriptor_, record.data() + written, record.size() - written);
+    if (n < 0) throw std::runtime_error("cannot write to " + filename_ + ".");
+    written += n;
+  }
+  fdatasync(descriptor_);
+}
+
+inline bool completion_journal::is_completed(const std::string& id) const {
+  return completed_ids_.contains(id);
+}
+
+inline void completion_journal::load_completed_ids(
+    const std::string& filename) {
+  this->scan(
+      filename, [this](const std::string& id, std::istream& is, size_t n) {
+        completed_ids_.insert(id);
+        is.ignore(n);
+      });
+}
+
+inline std::unique_ptr<completion_journal>
+completion_journal::open_rank_journal(
+    const std::string& prefix, int rank, int size, std::ostream& os) {
+  auto journal_name = [&prefix](int k) {
+    return prefix + "-" + std::to_string(k) + ".journal";
+  };
+  auto journal = std::make_unique<completion_journal>(journal_name(rank));
+  for (int k = 0; std::filesystem::exists(journal_name(k)); k++) {
+    if (k != rank) journal->load_completed_ids(journal_name(k));
+    if (k == rank || (rank == 0 && k >= size)) replay(journal_name(k), os);
+  }
+  return journal;
+}
+
+inline void completion_journal::replay(
+    const std::string& filename, std::ostream& os) {
+  scan(filename, [&os](const std::string&, std::istream& is, size_t n) {
+    std::string output(n, '\0');
+    is.read(output.data(), n);
+    os << output;
+  });
+}
+
+// Invokes handler(id, stream, nbytes) for each complete record, the handler
+// must consume exactly nbytes; returns the length of the valid journal part.
+inline size_t completion_journal::scan(
+    const std::string& filename, record_handler_t handler) {
+  std::ifstream is(filename, std::ios::binary);
+  if (!is.is_open()) return 0;
+  is.seekg(0, std::ios::end);
+  size_t file_size = is.tellg(), valid_length = 0;
+  is.seekg(0);
+  for (std::string line; std::getline(is, line) && !is.eof();) {
+    std::istringstream header(line);
+    std::string tag, id;
+    size_t n;
+    if (!(header >> tag >> id >> n) || tag != "@gtrace-journal") break;
+    size_t record_end = (size_t)is.tellg() + n;
+    if (record_end > file_size) break;
+    handler(id, is, n);
+    valid_length = record_end;
+  }
+  return valid_length;
+}
+
+#endif  // GTRACE_COMPLETION_JOURNAL
@@ -0,0 +1,94 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/cost_table.hh, this file is part of gtrace.
+
+#ifndef GTRACE_COST_TABLE
+#define GTRACE_COST_TABLE
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*!
+Table of orbit costs (wall-clock seconds) recorded by a previous run.
+---------------------------------------------------------------------
+
+Reads a text file with one `id cost` pair per line, as written by the ensemble
+drivers with the option `-cost-output`, skipping comment lines (starting with
+`#`). The per-process files `name-nnn` written by the MPI drivers are merged as
+well, so the table `name` covers all ranks of the recording run (whatever the
+number of ranks reading it). Ids not found in the table have no known cost.
+`longest_first_order()` returns the permutation sorting a set of predicted costs
+in decreasing order (stable), as used to start the most expensive orbits first.
+!*/
+class cost_table {
+ public:
+  cost_table(const std::string& filename);
+  std::optional<double> operator()(const std::string& id) const;
+ private:
+  std::unordered_map<std::string, double> costs_;
+  bool read(const std::string& filename);
+};
+
+inline cost_table::cost_table(const std::string& filename) {
+  auto rank_filename = [&](size_t rank) {
+    return filename + "-" + std::to_string(rank);
+  };
+  bool is_read = this->read(filename);
+  for (size_t rank = 0; this->read(rank_filename(rank)); rank++) is_read = true;
+  if (!is_read)
+    throw std::runtime_error("cannot read from file " + filename + ".\n");
+}
+
+inline bool cost_table::read(const std::string& filename) {
+  std::ifstream in_stream(filename);
+  if (!in_stream.is_open()) return false;
+  for (std::string line; std::getline(in_stream, line);) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream fields(line);
+    std::string id;
+    double cost;
+    if (!(fields >> id >> cost))
+      throw std::runtime_error("malformed cost file " + filename + ".\n");
+    costs_[id] = cost;
+  }
+  return true;
+}
+
+inline std::optional<double> cost_table::operator()(
+    const std::string& id) const {
+  auto it = costs_.find(id);
+  if (it == costs_.end()) return std::nullopt;
+  return it->second;
+}
+
+inline std::vector<size_t> longest_first_order(
+    const std::vector<double>& costs) {
+  std::vector<size_t> order(costs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::stable_sort(
+      order, [&](size_t i, size_t j) { return costs[i] > costs[j]; });
+  return order;
+}
+
+#endif  // GTRACE_COST_TABLE
@@ -0,0 +1,187 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/gzip_ostream.hh, this file is part of gtrace.
+
+#ifndef GTRACE_GZIP_OSTREAM
+#define GTRACE_GZIP_OSTREAM
+
+#include <gtrace/tools/bounded_queue.hh>
+
+#ifndef GTRACE_NO_ZLIB
+#include <zlib.h>
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*!
+Output stream compressed in gzip format by background threads.
+--------------------------------------------------------------
+
+Everything written to a `gzip_ostream` is gathered in blocks of `block_size`
+bytes, which are compressed by a pool of `n_threads` background threads (with
+zlib, at the given `level`, 1 to 9) and written to the `sink` stream buffer in
+their original order. Each block becomes a complete gzip member, so the output
+is a standard multi-member gzip file, read as a single stream by `zcat`,
+python's `gzip` module, or any other zlib-based reader. Writers never wait for
+the compression, except when all threads are busy and `2*n_threads` blocks are
+already queued (backpressure). Flushing the stream cuts the current block short
+and waits until everything written so far reaches the sink as complete gzip
+members, readable even if the process is killed afterwards (small members
+compress poorly, so flushes should be rare). `close()`, called also by the
+destructor, throws if the sink has failed. Built with `GTRACE_NO_ZLIB`, the
+stream compresses nothing and fails on the first block.
+!*/
+class gzip_streambuf : public std::streambuf {
+ public:
+  gzip_streambuf(
+      std::streambuf* sink, int level, size_t n_threads, size_t block_size);
+  virtual ~gzip_streambuf();
+  void close();
+ protected:
+  virtual int_type overflow(int_type c) override;
+  virtual int sync() override;
+ private:
+  struct block_t {
+    size_t index;
+    std::string data;
+  };
+  std::streambuf* const sink_;
+  const int level_;
+  const size_t block_size_;
+  std::string block_;
+  size_t next_index_ = 0, next_written_ = 0;
+  bounded_queue<block_t> blocks_;
+  std::map<size_t, std::string> compressed_;
+  std::mutex sink_mutex_;
+  std::condition_variable written_;
+  std::atomic<bool> is_failed_ = false;
+  std::vector<std::jthread> compressors_;
+  bool is_closed_ = false;
+  void compress_blocks();
+  void submit_block();
+};
+
+class gzip_ostream : public std::ostream {
+ public:
+  gzip_ostream(
+      std::streambuf* sink, int level, size_t n_threads,
+      size_t block_size = 1 << 20)
+      : std::ostream(nullptr), buffer_(sink, level, n_threads, block_size) {
+    this->rdbuf(&buffer_);
+  };
+  void close() { buffer_.close(); };
+ private:
+  gzip_streambuf buffer_;
+};
+
+inline gzip_streambuf::gzip_streambuf(
+    std::streambuf* sink, int level, size_t n_threads, size_t block_size)
+    : sink_(sink), level_(level), block_size_(block_size > 0 ? block_size : 1),
+      blocks_(2 * std::max<size_t>(n_threads, 1)) {
+  block_.resize(block_size_);
+  this->setp(block_.data(), block_.data() + block_.size());
+  for (size_t i = 0; i < std::max<size_t>(n_threads, 1); i++)
+    compressors_.emplace_back(&gzip_streambuf::compress_blocks, this);
+}
+
+inline gzip_streambuf::~gzip_streambuf() {
+  try {
+    this->close();
+  } catch (...) {
+  }
+}
+
+inline void gzip_streambuf::close() {
+  if (is_closed_) return;
+  is_closed_ = true;
+  this->submit_block();
+  this->setp(nullptr, nullptr);
+  blocks_.close();
+  compressors_.clear();
+  if (is_failed_ || sink_->pubsync() != 0)
+    throw std::runtime_error("cannot write compressed output.");
+}
+
+inline void gzip_streambuf::compress_blocks() {
+  while (auto block = blocks_.pop()) {
+    std::string compressed;
+#ifndef GTRACE_NO_ZLIB
+    z_stream stream = {};
+    if (deflateInit2(
+            &stream, level_, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) ==
+        Z_OK) {
+      compressed.resize(deflateBound(&stream, block->data.size()));
+      stream.next_in = reinterpret_cast<Bytef*>(block->data.data());
+      stream.avail_in = block->data.size();
+      stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+      stream.avail_out = compressed.size();
+      if (deflate(&stream, Z_FINISH) != Z_STREAM_END) is_failed_ = true;
+      compressed.resize(stream.total_out);
+      deflateEnd(&stream);
+    } else is_failed_ = true;
+#else
+    is_failed_ = true;
+#endif
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    compressed_.emplace(block->index, std::move(compressed));
+    for (auto it = compressed_.begin();
+         it != compressed_.end() && it->first == next_written_;
+         it = compressed_.erase(it), next_written_++)
+      if (sink_->sputn(it->second.data(), it->second.size()) !=
+          (std::streamsize)it->second.size())
+        is_failed_ = true;
+    written_.notify_all();
+  }
+}
+
+inline gzip_streambuf::int_type gzip_streambuf::overflow(int_type c) {
+  if (is_closed_) return traits_type::eof();
+  this->submit_block();
+  if (traits_type::eq_int_type(c, traits_type::eof()))
+    return traits_type::not_eof(c);
+  *this->pptr() = traits_type::to_char_type(c);
+  this->pbump(1);
+  return c;
+}
+
+inline int gzip_streambuf::sync() {
+  if (is_closed_) return 0;
+  this->submit_block();
+  std::unique_lock<std::mutex> lock(sink_mutex_);
+  written_.wait(lock, [this]() { return next_written_ == next_index_; });
+  return (is_failed_ || sink_->pubsync() != 0 ? -1 : 0);
+}
+
+inline void gzip_streambuf::submit_block() {
+  size_t size = this->pptr() - this->pbase();
+  if (size == 0) return;
+  block_.resize(size);
+  blocks_.push({next_index_++, std::move(block_)});
+  block_ = std::string(block_size_, '\0');
+  this->setp(block_.data(), block_.data() + block_.size());
+}
+
+#endif  // GTRACE_GZIP_OSTREAM
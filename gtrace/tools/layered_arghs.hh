@@ -0,0 +1,67 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/layered_arghs.hh, this file is part of gtrace.
+
+#ifndef GTRACE_LAYERED_ARGHS
+#define GTRACE_LAYERED_ARGHS
+
+#include <gtrace/tools/argh.h>
+
+#include <string>
+#include <vector>
+
+/*!
+Overlays a gyron's private options on the shared command line.
+---------------------------------------------------------------
+
+`layered_flag(arghs, name, base)` is the value of the flag `name` in `arghs`,
+if set there either as `-name` (true) or as `-name=val` (false for `val` one of
+0, false, no, or off, true otherwise), or `base` if absent; a gyron's private
+line may thus switch off a flag set on the shared one (eg, `-pxyz=0`).
+`layered_arghs(shared, private)` builds a single parser holding the options of
+both lines, private parameters and flags taking precedence over shared ones by
+the same rules, for boxes built from a full option set (eg, observers without a
+builder of their own). It costs a pass over the shared options, cheap next to
+the integration of an orbit.
+!*/
+inline bool layered_flag(
+    const argh::parser& arghs, const std::string& name, bool base) {
+  if (arghs[name]) return true;
+  std::string value;
+  if (!(arghs(name) >> value)) return base;
+  return !(value == "0" || value == "false" || value == "no" || value == "off");
+}
+
+inline argh::parser layered_arghs(
+    const argh::parser& shared_arghs, const argh::parser& private_arghs) {
+  std::vector<std::string> tokens = {"gtrace"};
+  for (const auto& [name, value] : private_arghs.params())
+    if (!shared_arghs[name]) tokens.push_back("-" + name + "=" + value);
+  for (const auto& [name, value] : shared_arghs.params())
+    if (!private_arghs[name] && !private_arghs.params().contains(name))
+      tokens.push_back("-" + name + "=" + value);
+  for (const std::string& name : shared_arghs.flags())
+    if (layered_flag(private_arghs, name, true)) tokens.push_back("-" + name);
+  for (const std::string& name : private_arghs.flags())
+    if (!shared_arghs[name]) tokens.push_back("-" + name);
+  std::vector<const char*> argv;
+  for (const std::string& token : tokens) argv.push_back(token.c_str());
+  argv.push_back(nullptr);
+  return argh::parser(argv.size() - 1, argv.data());
+}
+
+#endif  // GTRACE_LAYERED_ARGHS
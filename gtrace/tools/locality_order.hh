@@ -0,0 +1,82 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/locality_order.hh, this file is part of gtrace.
+
+#ifndef GTRACE_LOCALITY_ORDER
+#define GTRACE_LOCALITY_ORDER
+
+#include <gtrace/boxes/pusher_box.hh>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+/*!
+Orders ensemble gyrons by the spatial locality of their initial conditions.
+---------------------------------------------------------------------------
+
+Returns the permutation that sorts a set of initial conditions along a Morton
+(z-order) space-filling curve of their initial positions `(qu, qv, qw)`,
+breaking ties by energy and pitch. Positions are quantised into 2^21 cells per
+axis over the bounding box of the set, so that gyrons starting close to each
+other (and thus probing the same regions of the field data) end up close in the
+returned order. The sort is stable.
+!*/
+inline uint64_t spread_bits_by_three(uint64_t x) {
+  x &= 0x1fffff;
+  x = (x | x << 32) & 0x1f00000000ffff;
+  x = (x | x << 16) & 0x1f0000ff0000ff;
+  x = (x | x << 8) & 0x100f00f00f00f00f;
+  x = (x | x << 4) & 0x10c30c30c30c30c3;
+  x = (x | x << 2) & 0x1249249249249249;
+  return x;
+}
+
+inline std::vector<size_t> locality_order(
+    const std::vector<gyron_ic_t>& initial_conditions) {
+  constexpr double cells = (1 << 21) - 1;
+  double lower[3], upper[3];
+  std::fill_n(lower, 3, std::numeric_limits<double>::max());
+  std::fill_n(upper, 3, std::numeric_limits<double>::lowest());
+  for (const gyron_ic_t& ic : initial_conditions)
+    for (int k = 0; double q : {ic.qu, ic.qv, ic.qw}) {
+      lower[k] = std::min(lower[k], q);
+      upper[k] = std::max(upper[k], q);
+      k++;
+    }
+  auto cell = [&](double q, int k) {
+    double range = upper[k] - lower[k];
+    return (uint64_t)(range > 0 ? cells * (q - lower[k]) / range : 0);
+  };
+  std::vector<std::tuple<uint64_t, double, double>> keys;
+  for (const gyron_ic_t& ic : initial_conditions)
+    keys.emplace_back(
+        spread_bits_by_three(cell(ic.qu, 0)) |
+            spread_bits_by_three(cell(ic.qv, 1)) << 1 |
+            spread_bits_by_three(cell(ic.qw, 2)) << 2,
+        ic.energy, ic.pitch);
+  std::vector<size_t> order(initial_conditions.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::stable_sort(
+      order, [&](size_t i, size_t j) { return keys[i] < keys[j]; });
+  return order;
+}
+
+#endif  // GTRACE_LOCALITY_ORDER
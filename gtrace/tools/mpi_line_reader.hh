@@ -0,0 +1,130 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/mpi_line_reader.hh, this file is part of gtrace.
+
+#ifndef GTRACE_MPI_LINE_READER
+#define GTRACE_MPI_LINE_READER
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*!
+Collective read of a text file split by lines among mpi processes.
+------------------------------------------------------------------
+
+The file is cut into as many contiguous byte ranges as processes in `comm` and
+each process reads its own range with a single collective MPI-IO call. A line
+belongs to the process whose range contains its first byte, thus every process
+also peeks the byte just before its range (to know whether a line starts there)
+and reads past its end until the last owned line is complete. All processes
+open the same file, no matter how many of them are running. The global index
+of the first line owned by each process is available after reading.
+!*/
+class mpi_line_reader {
+ public:
+  mpi_line_reader(MPI_Comm comm, const std::string& filename);
+  ~mpi_line_reader() { MPI_File_close(&file_); };
+  size_t first_line_index() const { return first_line_index_; };
+  std::vector<std::string> read_lines();
+ private:
+  static constexpr MPI_Offset tail_block_ = 65536;
+  static constexpr MPI_Offset max_chunk_ = INT_MAX / 2;
+  MPI_Comm comm_;
+  MPI_File file_;
+  MPI_Offset file_size_;
+  size_t first_line_index_ = 0;
+  std::vector<char> read_range_collectively(MPI_Offset from, MPI_Offset to);
+  void read_tail(std::vector<char>& buffer, MPI_Offset from);
+};
+
+inline mpi_line_reader::mpi_line_reader(
+    MPI_Comm comm, const std::string& filename)
+    : comm_(comm) {
+  int error = MPI_File_open(
+      comm_, filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &file_);
+  if (error != MPI_SUCCESS)
+    throw std::runtime_error("cannot read from file " + filename + ".\n");
+  MPI_File_get_size(file_, &file_size_);
+}
+
+inline std::vector<std::string> mpi_line_reader::read_lines() {
+  int rank, size;
+  MPI_Comm_rank(comm_, &rank);
+  MPI_Comm_size(comm_, &size);
+  MPI_Offset begin = file_size_ * rank / size;
+  MPI_Offset end = file_size_ * (rank + 1) / size;
+  MPI_Offset from = (begin > 0 ? begin - 1 : 0);
+  std::vector<char> buffer = this->read_range_collectively(from, end);
+  if (end < file_size_ && (buffer.empty() || buffer.back() != '\n'))
+    this->read_tail(buffer, end);
+
+  std::vector<std::string> lines;
+  auto line_start = buffer.begin() + (begin - from);
+  if (begin > 0 && buffer.front() != '\n') {
+    line_start = std::find(line_start, buffer.end(), '\n');
+    if (line_start != buffer.end()) ++line_start;
+  }
+  while (line_start < buffer.end() &&
+         from + (line_start - buffer.begin()) < end) {
+    auto line_end = std::find(line_start, buffer.end(), '\n');
+    lines.emplace_back(line_start, line_end);
+    line_start = (line_end == buffer.end() ? line_end : line_end + 1);
+  }
+  unsigned long long n_lines = lines.size(), n_lines_before = 0;
+  MPI_Exscan(
+      &n_lines, &n_lines_before, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm_);
+  first_line_index_ = (rank > 0 ? n_lines_before : 0);
+  return lines;
+}
+
+inline std::vector<char> mpi_line_reader::read_range_collectively(
+    MPI_Offset from, MPI_Offset to) {
+  MPI_Offset n_chunks = (to - from + max_chunk_ - 1) / max_chunk_;
+  MPI_Allreduce(MPI_IN_PLACE, &n_chunks, 1, MPI_OFFSET, MPI_MAX, comm_);
+  std::vector<char> buffer(to - from);
+  for (MPI_Offset i = 0; i < n_chunks; i++) {
+    MPI_Offset offset = std::min(i * max_chunk_, to - from);
+    int count = std::min(max_chunk_, to - from - offset);
+    MPI_File_read_at_all(
+        file_, from + offset, buffer.data() + offset, count, MPI_CHAR,
+        MPI_STATUS_IGNORE);
+  }
+  return buffer;
+}
+
+inline void mpi_line_reader::read_tail(
+    std::vector<char>& buffer, MPI_Offset from) {
+  while (from < file_size_) {
+    int count = std::min(tail_block_, file_size_ - from);
+    size_t old_size = buffer.size();
+    buffer.resize(old_size + count);
+    MPI_File_read_at(
+        file_, from, buffer.data() + old_size, count, MPI_CHAR,
+        MPI_STATUS_IGNORE);
+    if (std::find(buffer.begin() + old_size, buffer.end(), '\n') !=
+        buffer.end())
+      return;
+    from += count;
+  }
+}
+
+#endif  // GTRACE_MPI_LINE_READER
@@ -0,0 +1,104 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/numa_topology.hh, this file is part of gtrace.
+
+#ifndef GTRACE_NUMA_TOPOLOGY
+#define GTRACE_NUMA_TOPOLOGY
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*!
+NUMA domains available to the running process.
+----------------------------------------------
+
+Reads the cpus of each NUMA node from `/sys/devices/system/node/nodeN/cpulist`
+(Linux), keeping only those in the process' affinity mask, so that an MPI rank
+bound to a socket by the launcher sees that socket alone. Nodes left without
+cpus (eg, memory-only ones) are dropped; without any NUMA information, all the
+allowed cpus make up a single domain. Workers are spread over the domains
+round-robin (`domain_of()`) and `bind_thread()` pins the calling thread to the
+cpus of a domain, whereupon the memory it allocates and touches first (eg, while
+building a `field_box_t`) is placed by the kernel on that domain's node.
+!*/
+class numa_topology {
+ public:
+  numa_topology();
+  void bind_thread(size_t domain) const;
+  size_t domain_of(size_t worker) const { return worker % domains_.size(); };
+  size_t size() const { return domains_.size(); };
+ private:
+  std::vector<cpu_set_t> domains_;
+  static cpu_set_t parse_cpulist(const std::string& cpulist);
+};
+
+inline numa_topology::numa_topology() {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    throw std::runtime_error("cannot read the cpu affinity of the process.");
+  std::map<size_t, cpu_set_t> nodes;
+  std::error_code error;
+  for (const auto& entry : std::filesystem::directory_iterator(
+           "/sys/devices/system/node", error)) {
+    std::string name = entry.path().filename().string();
+    if (!name.starts_with("node") || name.size() == 4 || !std::isdigit(name[4]))
+      continue;
+    std::ifstream cpulist_stream(entry.path() / "cpulist");
+    std::string cpulist;
+    std::getline(cpulist_stream, cpulist);
+    cpu_set_t cpus = parse_cpulist(cpulist);
+    CPU_AND(&cpus, &cpus, &allowed);
+    if (CPU_COUNT(&cpus) > 0) nodes[std::stoul(name.substr(4))] = cpus;
+  }
+  for (const auto& [node, cpus] : nodes) domains_.push_back(cpus);
+  if (domains_.empty()) domains_.push_back(allowed);
+}
+
+inline void numa_topology::bind_thread(size_t domain) const {
+  const cpu_set_t& cpus = domains_[domain % domains_.size()];
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+    throw std::runtime_error("cannot bind thread to numa domain.");
+}
+
+inline cpu_set_t numa_topology::parse_cpulist(const std::string& cpulist) {
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  std::istringstream list_stream(cpulist);
+  for (std::string range; std::getline(list_stream, range, ',');) {
+    if (range.empty()) continue;
+    size_t dash = range.find('-');
+    size_t first = std::stoul(range.substr(0, dash));
+    size_t last = (dash == std::string::npos
+                       ? first
+                       : std::stoul(range.substr(dash + 1)));
+    for (size_t cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+      CPU_SET(cpu, &cpus);
+  }
+  return cpus;
+}
+
+#endif  // GTRACE_NUMA_TOPOLOGY
@@ -19,12 +19,17 @@
 #ifndef GTRACE_ODEINT_STEPPER
 #define GTRACE_ODEINT_STEPPER
 
+#include <istream>
+#include <ostream>
+
 template<typename EqSystem> class odeint_stepper {
  public:
   using state_t = EqSystem::state;
   virtual ~odeint_stepper() {};
   virtual double do_step(
       const EqSystem& eqs, state_t& state, double t, double dt) = 0;
+  virtual void save_history(std::ostream&) const {};
+  virtual void load_history(std::istream&) {};
 };
 
 #endif  // GTRACE_ODEINT_STEPPER
@@ -21,6 +21,7 @@
 
 #include <gyronimo/dynamics/odeint_adapter.hh>
 
+#include <gtrace/tools/binary_io.hh>
 #include <gtrace/tools/odeint_stepper.hh>
 
 #include <boost/numeric/odeint/stepper/adams_bashforth_moulton.hpp>
@@ -41,13 +42,75 @@ class stepper_wrapper : public odeint_stepper<EqSystem> {
   ConcreteStepper stepper_;
 };
 
+/*!
+Adams-Bashforth-Moulton stepper with a serialisable multistep history.
+----------------------------------------------------------------------
+
+Performs exactly the same operations as `adams_bashforth_moulton<Steps>`, but
+holds the predictor and corrector itself in order to reach the history of past
+derivatives. `save_history()` stores these derivatives (oldest first), while
+`load_history()` feeds them back into a freshly reset predictor through a replay
+system, leaving it in the very same state it had when saved.
+!*/
+template<size_t Steps, typename EqSystem>
+class adams_wrapper : public odeint_stepper<EqSystem> {
+ public:
+  using state_t = EqSystem::state;
+  using abm_t = boost::numeric::odeint::adams_bashforth_moulton<Steps, state_t>;
+  virtual ~adams_wrapper() {};
+  virtual double do_step(
+      const EqSystem& eqs, state_t& state, double t, double dt) override {
+    gyronimo::odeint_adapter system(&eqs);
+    if (predictor_.is_initialized()) {
+      predictor_.do_step(system, state, t, predicted_, dt);
+      corrector_.do_step(
+          system, state, predicted_, t + dt, state, dt,
+          predictor_.step_storage());
+    } else {
+      predictor_.do_step(system, state, t, dt);
+      history_size_++;
+    }
+    return t + dt;
+  };
+  virtual void save_history(std::ostream& os) const override {
+    write_binary(os, history_size_);
+    for (size_t i = history_size_; i-- > 0;)
+      write_binary(os, predictor_.step_storage()[i].m_v);
+  };
+  virtual void load_history(std::istream& is) override {
+    size_t history_size;
+    read_binary(is, history_size);
+    if (history_size >= Steps)
+      throw std::runtime_error("inconsistent adams stepper history.");
+    predictor_.reset();
+    history_size_ = 0;
+    state_t scratch = {}, derivative;
+    for (size_t i = 0; i < history_size; i++) {
+      read_binary(is, derivative);
+      predictor_.do_step(replay_system{derivative}, scratch, 0.0, 0.0);
+      history_size_++;
+    }
+  };
+ private:
+  struct replay_system {
+    const state_t& derivative;
+    void operator()(const state_t& x, state_t& dxdt, double t) const {
+      dxdt = derivative;
+    };
+  };
+  typename abm_t::adams_bashforth_type predictor_;
+  typename abm_t::adams_moulton_type corrector_;
+  state_t predicted_;
+  size_t history_size_ = 0;
+};
+
 template<typename EqSystem>
 odeint_stepper<EqSystem>* odeint_stepper_factory(
     const std::string& stepper_name) {
   using namespace boost::numeric::odeint;
   using state_t = EqSystem::state;
   if (stepper_name == "adams")
-    return new stepper_wrapper<adams_bashforth_moulton<8, state_t>, EqSystem>;
+    return new adams_wrapper<8, EqSystem>;
   if (stepper_name == "fehlberg")
     return new stepper_wrapper<runge_kutta_fehlberg78<state_t>, EqSystem>;
   if (stepper_name == "rungekutta")
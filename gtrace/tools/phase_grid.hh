@@ -0,0 +1,118 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/phase_grid.hh, this file is part of gtrace.
+
+#ifndef GTRACE_PHASE_GRID
+#define GTRACE_PHASE_GRID
+
+#include <gtrace/tools/reduction_registry.hh>
+#include <gtrace/tools/text_record.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*!
+Regular grid of weights deposited over a few phase-space axes.
+--------------------------------------------------------------
+
+Each axis spans `[min, max)` with `bins` equal bins, as parsed by
+`parse_axes()` from a comma-separated list of `name:min:max:bins` items (eg,
+`qu:0:1:64,pitch:-1:1:32`). `deposit(point, weight)` adds `weight` to the cell
+holding `point` (one coordinate per axis, in the axes' order), and ignores
+points outside the grid. As a `reduction_entry_t`, the cells are summed over
+threads and processes; `write()` prints a line per non-empty cell, with the
+centre of the cell along each axis followed by its weight (empty cells are
+skipped, since deposition grids are typically sparse).
+!*/
+class phase_grid : public reduction_entry_t {
+ public:
+  struct axis_t {
+    std::string name;
+    double min, max;
+    size_t bins;
+  };
+  phase_grid(const std::vector<axis_t>& axes);
+  virtual ~phase_grid() {};
+  const std::vector<axis_t>& axes() const { return axes_; };
+  void deposit(const std::vector<double>& point, double weight);
+  virtual std::span<double> data() override { return cells_; };
+  virtual void write(std::ostream& os) const override;
+  static std::vector<axis_t> parse_axes(const std::string& axes_list);
+ private:
+  const std::vector<axis_t> axes_;
+  std::vector<double> cells_;
+};
+
+inline phase_grid::phase_grid(const std::vector<axis_t>& axes) : axes_(axes) {
+  size_t n_cells = 1;
+  for (const axis_t& axis : axes_) n_cells *= axis.bins;
+  cells_.resize(axes_.empty() ? 0 : n_cells, 0);
+}
+
+inline void phase_grid::deposit(
+    const std::vector<double>& point, double weight) {
+  size_t index = 0;
+  for (size_t i = 0; i < axes_.size(); i++) {
+    const axis_t& axis = axes_[i];
+    double bin = std::floor(
+        axis.bins * (point[i] - axis.min) / (axis.max - axis.min));
+    if (!(bin >= 0 && bin < axis.bins)) return;
+    index = index * axis.bins + (size_t)bin;
+  }
+  cells_[index] += weight;
+}
+
+inline std::vector<phase_grid::axis_t> phase_grid::parse_axes(
+    const std::string& axes_list) {
+  std::vector<axis_t> axes;
+  std::istringstream list_stream(axes_list);
+  for (std::string item; std::getline(list_stream, item, ',');) {
+    std::string fields = item;
+    std::replace(fields.begin(), fields.end(), ':', ' ');
+    std::istringstream item_stream(fields);
+    axis_t axis;
+    if (!(item_stream >> axis.name >> axis.min >> axis.max >> axis.bins) ||
+        axis.bins == 0 || !(axis.max > axis.min))
+      throw std::invalid_argument("invalid grid axis " + item + ".");
+    axes.push_back(axis);
+  }
+  return axes;
+}
+
+inline void phase_grid::write(std::ostream& os) const {
+  os << "# fields:";
+  for (const axis_t& axis : axes_) os << " " << axis.name;
+  os << " weight\n";
+  for (size_t index = 0; index < cells_.size(); index++) {
+    if (cells_[index] == 0) continue;
+    std::list<double> record(1, cells_[index]);
+    for (size_t i = axes_.size(), rest = index; i-- > 0;) {
+      const axis_t& axis = axes_[i];
+      double width = (axis.max - axis.min) / axis.bins;
+      record.push_front(axis.min + width * (rest % axis.bins + 0.5));
+      rest /= axis.bins;
+    }
+    text_record::write(os, record);
+  }
+}
+
+#endif  // GTRACE_PHASE_GRID
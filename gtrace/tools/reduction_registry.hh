@@ -0,0 +1,126 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/reduction_registry.hh, this file is part of gtrace.
+
+#ifndef GTRACE_REDUCTION_REGISTRY
+#define GTRACE_REDUCTION_REGISTRY
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+class reduction_entry_t {
+ public:
+  virtual ~reduction_entry_t() {};
+  virtual std::span<double> data() = 0;
+  virtual void write(std::ostream& os) const = 0;
+};
+
+/*!
+Thread-local accumulators of observers, reduced by the drivers.
+---------------------------------------------------------------
+
+Observers are built per gyron and know nothing of the driver running them, so
+those accumulating results over the whole ensemble (eg, `phase_deposition`) get
+their accumulator from the `global()` registry: `local<Entry>(name, args...)`
+returns the calling thread's instance of the entry `name`, built from `args` on
+the thread's first request, so that accumulating needs no locking (the registry
+is locked only while looking up the entry, once per gyron). At the end of the
+run, the driver calls `reduce()`, which sums the `data()` of all threads' copies
+of each entry, element by element, and returns one entry per name in the order
+of the names (the same in all processes, whose entries the MPI drivers sum
+further before writing); the registry is left empty. All copies of an entry must
+have data of the same size. Within the lifetime of a `discarding_scope` object,
+`local()` returns instead scratch copies that are never reduced, for runs whose
+results must not count (eg, the cost probes of `driver_box_t`); the calling
+thread's scratch copies are dropped when the scope ends, so the objects using
+them must not outlive it.
+!*/
+class reduction_registry {
+ public:
+  class discarding_scope {
+   public:
+    discarding_scope() { is_discarding_ = true; };
+    ~discarding_scope();
+  };
+  static reduction_registry& global() {
+    static reduction_registry registry;
+    return registry;
+  };
+  template<typename Entry, typename... Args>
+  Entry& local(const std::string& name, Args&&... args);
+  std::vector<std::unique_ptr<reduction_entry_t>> reduce();
+  bool empty();
+ private:
+  using entry_ptr = std::unique_ptr<reduction_entry_t>;
+  static inline thread_local bool is_discarding_ = false;
+  std::mutex mutex_;
+  std::map<std::string, std::map<std::thread::id, entry_ptr>> entries_;
+  std::map<std::string, std::map<std::thread::id, entry_ptr>> discarded_;
+};
+
+inline reduction_registry::discarding_scope::~discarding_scope() {
+  is_discarding_ = false;
+  reduction_registry& registry = global();
+  std::lock_guard<std::mutex> lock(registry.mutex_);
+  auto& discarded = registry.discarded_;
+  for (auto it = discarded.begin(); it != discarded.end();) {
+    it->second.erase(std::this_thread::get_id());
+    it = (it->second.empty() ? discarded.erase(it) : std::next(it));
+  }
+}
+
+template<typename Entry, typename... Args>
+Entry& reduction_registry::local(const std::string& name, Args&&... args) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& entries = (is_discarding_ ? discarded_ : entries_);
+  auto& entry = entries[name][std::this_thread::get_id()];
+  if (!entry) entry = std::make_unique<Entry>(std::forward<Args>(args)...);
+  return static_cast<Entry&>(*entry);
+}
+
+inline std::vector<std::unique_ptr<reduction_entry_t>>
+reduction_registry::reduce() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::unique_ptr<reduction_entry_t>> reduced;
+  for (auto& [name, copies] : entries_) {
+    auto sum = std::move(copies.begin()->second);
+    std::span<double> sum_data = sum->data();
+    for (auto it = std::next(copies.begin()); it != copies.end(); it++) {
+      std::span<double> data = it->second->data();
+      if (data.size() != sum_data.size())
+        throw std::runtime_error("inconsistent copies of reduction " + name);
+      for (size_t i = 0; i < data.size(); i++) sum_data[i] += data[i];
+    }
+    reduced.push_back(std::move(sum));
+  }
+  entries_.clear();
+  return reduced;
+}
+
+inline bool reduction_registry::empty() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.empty();
+}
+
+#endif  // GTRACE_REDUCTION_REGISTRY
@@ -0,0 +1,113 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/reorder_buffer.hh, this file is part of gtrace.
+
+#ifndef GTRACE_REORDER_BUFFER
+#define GTRACE_REORDER_BUFFER
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+/*!
+Releases indexed output blocks in index order, within a bounded memory.
+-----------------------------------------------------------------------
+
+Blocks finished out of turn are `put()` under their index and `release()` hands
+over, in increasing index order, all those contiguous to the last released one
+(starting at index zero). At most `memory_limit` bytes of blocks are held in
+memory: past that, the blocks with the largest indices (ie, the ones needed
+last) are spilled to the file `spill_filename`, created only when first needed,
+from where they are read back in their turn. A single straggling block thus
+never makes the memory footprint grow with the ensemble. The spill file is
+removed on destruction.
+!*/
+class reorder_buffer {
+ public:
+  reorder_buffer(size_t memory_limit, const std::string& spill_filename)
+      : memory_limit_(memory_limit), spill_filename_(spill_filename) {};
+  ~reorder_buffer();
+  void put(size_t index, std::string&& block);
+  template<typename Sink> void release(Sink&& sink);
+ private:
+  struct spilled_t {
+    std::streamoff offset;
+    size_t size;
+  };
+  const size_t memory_limit_;
+  const std::string spill_filename_;
+  size_t memory_size_ = 0, next_index_ = 0;
+  std::map<size_t, std::string> blocks_;
+  std::map<size_t, spilled_t> spilled_;
+  std::fstream spill_stream_;
+  std::optional<std::string> take(size_t index);
+};
+
+inline reorder_buffer::~reorder_buffer() {
+  if (!spill_stream_.is_open()) return;
+  spill_stream_.close();
+  std::error_code error;
+  std::filesystem::remove(spill_filename_, error);
+}
+
+inline void reorder_buffer::put(size_t index, std::string&& block) {
+  memory_size_ += block.size();
+  blocks_.emplace(index, std::move(block));
+  while (memory_size_ > memory_limit_ && blocks_.size() > 1) {
+    auto node = blocks_.extract(std::prev(blocks_.end()));
+    if (!spill_stream_.is_open()) {
+      spill_stream_.open(
+          spill_filename_, std::ios::binary | std::ios::in | std::ios::out |
+                               std::ios::trunc);
+      if (!spill_stream_.is_open())
+        throw std::runtime_error("cannot write to file " + spill_filename_);
+    }
+    spill_stream_.seekp(0, std::ios::end);
+    spilled_t spilled = {spill_stream_.tellp(), node.mapped().size()};
+    spill_stream_.write(node.mapped().data(), spilled.size);
+    if (!spill_stream_)
+      throw std::runtime_error("cannot write to file " + spill_filename_);
+    spilled_.emplace(node.key(), spilled);
+    memory_size_ -= spilled.size;
+  }
+}
+
+template<typename Sink> void reorder_buffer::release(Sink&& sink) {
+  for (auto block = this->take(next_index_); block;
+       block = this->take(++next_index_))
+    sink(*block);
+}
+
+inline std::optional<std::string> reorder_buffer::take(size_t index) {
+  if (auto node = blocks_.extract(index)) {
+    memory_size_ -= node.mapped().size();
+    return std::move(node.mapped());
+  }
+  auto node = spilled_.extract(index);
+  if (!node) return std::nullopt;
+  std::string block(node.mapped().size, '\0');
+  spill_stream_.seekg(node.mapped().offset);
+  spill_stream_.read(block.data(), block.size());
+  if (!spill_stream_)
+    throw std::runtime_error("cannot read from file " + spill_filename_);
+  return block;
+}
+
+#endif  // GTRACE_REORDER_BUFFER
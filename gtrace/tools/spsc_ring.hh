@@ -0,0 +1,67 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/spsc_ring.hh, this file is part of gtrace.
+
+#ifndef GTRACE_SPSC_RING
+#define GTRACE_SPSC_RING
+
+#include <atomic>
+#include <optional>
+#include <vector>
+
+/*!
+Lock-free single-producer single-consumer ring of bounded capacity.
+-------------------------------------------------------------------
+
+Links one producer thread to one consumer thread without locks: each side only
+advances its own counter (`tail_` for the producer, `head_` for the consumer)
+and reads the other's. `try_pop()` never blocks, while `push()` waits (via
+`std::atomic::wait`) while the ring is full, thus bounding the memory held by
+the items in transit and holding back a producer that runs ahead of its
+consumer (backpressure).
+!*/
+template<typename T> class spsc_ring {
+ public:
+  spsc_ring(size_t capacity)
+      : capacity_(capacity > 0 ? capacity : 1), slots_(capacity_) {};
+  void push(T&& item);
+  std::optional<T> try_pop();
+ private:
+  const size_t capacity_;
+  std::vector<T> slots_;
+  std::atomic<size_t> head_ = 0, tail_ = 0;
+};
+
+template<typename T> void spsc_ring<T>::push(T&& item) {
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  for (size_t head; tail - (head = head_.load(std::memory_order_acquire)) ==
+                    capacity_;)
+    head_.wait(head, std::memory_order_acquire);
+  slots_[tail % capacity_] = std::move(item);
+  tail_.store(tail + 1, std::memory_order_release);
+}
+
+template<typename T> std::optional<T> spsc_ring<T>::try_pop() {
+  size_t head = head_.load(std::memory_order_relaxed);
+  if (head == tail_.load(std::memory_order_acquire)) return std::nullopt;
+  T item = std::move(slots_[head % capacity_]);
+  head_.store(head + 1, std::memory_order_release);
+  head_.notify_one();
+  return item;
+}
+
+#endif  // GTRACE_SPSC_RING
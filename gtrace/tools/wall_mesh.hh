@@ -0,0 +1,322 @@
+// gtrace -- a flexible gyron-tracing application for electromagnetic fields.
+// Copyright (C) 2026 Paulo Rodrigues.
+
+// gtrace is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+
+// gtrace is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+// for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with gtrace. If not, see <https://www.gnu.org/licenses/>.
+
+// @tools/wall_mesh.hh, this file is part of gtrace.
+
+#ifndef GTRACE_WALL_MESH
+#define GTRACE_WALL_MESH
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*!
+Triangulated wall mesh, with a bounding-volume hierarchy for segment queries.
+-----------------------------------------------------------------------------
+
+Reads a triangle mesh from an STL (binary or ascii) or a Wavefront OBJ file
+(polygonal faces are split into triangle fans), with its coordinates multiplied
+by `scale`, and builds a bounding-volume hierarchy over the triangles: a binary
+tree of axis-aligned boxes, split at the median centroid along the longest axis
+of each box down to leaves of at most `leaf_size_` triangles, stored as a flat
+array (with single-precision boxes rounded outwards, halving the memory traffic)
+along with the triangles (reordered for locality). `intersect(a, b)` returns the
+first crossing of the segment from `a` to `b` with the mesh (ie, the fraction of
+the segment covered, the crossing point, and the triangle's index in the file),
+if any, visiting only the boxes the segment crosses (the nearer child first,
+pruning boxes beyond the nearest crossing found so far) and testing triangles by
+the Möller-Trumbore algorithm. Queries of segments short compared to the mesh
+thus cost the depth of the tree, ie, the logarithm of the number of triangles,
+for meshes of millions of triangles. Objects are immutable once built and are
+safely shared by threads.
+!*/
+class wall_mesh {
+ public:
+  using point_t = std::array<double, 3>;
+  struct hit_t {
+    double fraction;
+    point_t point;
+    size_t triangle;
+  };
+  wall_mesh(const std::string& filename, double scale = 1);
+  std::optional<hit_t> intersect(const point_t& a, const point_t& b) const;
+  size_t size() const { return triangles_.size(); };
+ private:
+  static constexpr size_t leaf_size_ = 4;
+  struct triangle_t {
+    point_t p0, e1, e2;
+    size_t index;
+  };
+  struct node_t {
+    std::array<float, 3> min, max;
+    uint32_t first, count;  // leaf if count > 0, else children first, first+1.
+  };
+  std::vector<triangle_t> triangles_;
+  std::vector<node_t> nodes_;
+  void build(std::vector<std::array<point_t, 3>>&& vertices);
+  static std::vector<std::array<point_t, 3>> read_obj(std::istream& is);
+  static std::vector<std::array<point_t, 3>> read_stl(
+      const std::string& filename);
+  static double entry_fraction(
+      const node_t& node, const point_t& a, const point_t& inverse_d,
+      double fraction_max);
+};
+
+inline wall_mesh::wall_mesh(const std::string& filename, double scale) {
+  std::string extension = std::filesystem::path(filename).extension().string();
+  std::transform(
+      extension.begin(), extension.end(), extension.begin(), ::tolower);
+  std::vector<std::array<point_t, 3>> vertices;
+  if (extension == ".stl") vertices = read_stl(filename);
+  else if (extension == ".obj") {
+    std::ifstream in_stream(filename);
+    if (!in_stream.is_open())
+      throw std::runtime_error("cannot read from file " + filename);
+    vertices = read_obj(in_stream);
+  } else throw std::invalid_argument("unknown wall-mesh format " + filename);
+  if (vertices.empty())
+    throw std::runtime_error("empty wall mesh in file " + filename);
+  for (auto& triangle : vertices)
+    for (point_t& p : triangle)
+      for (double& x : p) x *= scale;
+  this->build(std::move(vertices));
+}
+
+inline void wall_mesh::build(std::vector<std::array<point_t, 3>>&& vertices) {
+  size_t n = vertices.size();
+  std::vector<point_t> centroids(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t k = 0; k < 3; k++)
+      centroids[i][k] =
+          (vertices[i][0][k] + vertices[i][1][k] + vertices[i][2][k]) / 3;
+  std::vector<uint32_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  struct range_t {
+    size_t node, first, count;
+  };
+  std::vector<range_t> pending = {{0, 0, n}};
+  nodes_.push_back({});
+  while (!pending.empty()) {
+    range_t range = pending.back();
+    pending.pop_back();
+    point_t min, max;
+    min.fill(std::numeric_limits<double>::max());
+    max.fill(std::numeric_limits<double>::lowest());
+    point_t centroid_min = min, centroid_max = max;
+    for (size_t i = range.first; i < range.first + range.count; i++)
+      for (size_t k = 0; k < 3; k++) {
+        for (const point_t& p : vertices[order[i]]) {
+          min[k] = std::min(min[k], p[k]);
+          max[k] = std::max(max[k], p[k]);
+        }
+        centroid_min[k] = std::min(centroid_min[k], centroids[order[i]][k]);
+        centroid_max[k] = std::max(centroid_max[k], centroids[order[i]][k]);
+      }
+    node_t node;
+    for (size_t k = 0; k < 3; k++) {
+      node.min[k] = std::nextafter((float)min[k], -HUGE_VALF);
+      node.max[k] = std::nextafter((float)max[k], HUGE_VALF);
+    }
+    if (range.count <= leaf_size_) {
+      node.first = range.first, node.count = range.count;
+      nodes_[range.node] = node;
+      continue;
+    }
+    size_t axis = 0;
+    for (size_t k = 1; k < 3; k++)
+      if (centroid_max[k] - centroid_min[k] >
+          centroid_max[axis] - centroid_min[axis])
+        axis = k;
+    auto begin = order.begin() + range.first;
+    size_t half = range.count / 2;
+    std::nth_element(
+        begin, begin + half, begin + range.count, [&](uint32_t i, uint32_t j) {
+          return centroids[i][axis] < centroids[j][axis];
+        });
+    node.first = nodes_.size(), node.count = 0;
+    nodes_[range.node] = node;
+    nodes_.push_back({}), nodes_.push_back({});
+    pending.push_back({node.first + 1, range.first + half, range.count - half});
+    pending.push_back({node.first, range.first, half});
+  }
+  triangles_.reserve(n);
+  for (uint32_t i : order) {
+    const auto& v = vertices[i];
+    triangle_t triangle = {.p0 = v[0], .e1 = {}, .e2 = {}, .index = i};
+    for (size_t k = 0; k < 3; k++) {
+      triangle.e1[k] = v[1][k] - v[0][k];
+      triangle.e2[k] = v[2][k] - v[0][k];
+    }
+    triangles_.push_back(triangle);
+  }
+}
+
+inline double wall_mesh::entry_fraction(
+    const node_t& node, const point_t& a, const point_t& inverse_d,
+    double fraction_max) {
+  double t_min = 0, t_max = fraction_max;
+  for (size_t k = 0; k < 3; k++) {
+    double t_0 = (node.min[k] - a[k]) * inverse_d[k];
+    double t_1 = (node.max[k] - a[k]) * inverse_d[k];
+    t_min = std::max(t_min, std::min(t_0, t_1));
+    t_max = std::min(t_max, std::max(t_0, t_1));
+  }
+  return (t_min <= t_max ? t_min : std::numeric_limits<double>::infinity());
+}
+
+inline std::optional<wall_mesh::hit_t> wall_mesh::intersect(
+    const point_t& a, const point_t& b) const {
+  point_t d = {b[0] - a[0], b[1] - a[1], b[2] - a[2]}, inverse_d;
+  for (size_t k = 0; k < 3; k++) inverse_d[k] = 1 / d[k];
+  auto cross = [](const point_t& u, const point_t& v) {
+    return point_t {
+        u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2],
+        u[0] * v[1] - u[1] * v[0]};
+  };
+  auto dot = [](const point_t& u, const point_t& v) {
+    return u[0] * v[0] + u[1] * v[1] + u[2] * v[2];
+  };
+  std::optional<hit_t> hit;
+  double fraction_max = 1;
+  struct pending_t {
+    uint32_t node;
+    double entry;
+  } stack[64];
+  size_t depth = 0;
+  double root_entry = entry_fraction(nodes_[0], a, inverse_d, fraction_max);
+  if (root_entry <= fraction_max) stack[depth++] = {0, root_entry};
+  while (depth > 0) {
+    pending_t pending = stack[--depth];
+    if (pending.entry > fraction_max) continue;
+    const node_t& node = nodes_[pending.node];
+    if (node.count == 0) {
+      pending_t near = {node.first, entry_fraction(
+          nodes_[node.first], a, inverse_d, fraction_max)};
+      pending_t far = {node.first + 1, entry_fraction(
+          nodes_[node.first + 1], a, inverse_d, fraction_max)};
+      if (far.entry < near.entry) std::swap(near, far);
+      if (far.entry <= fraction_max) stack[depth++] = far;
+      if (near.entry <= fraction_max) stack[depth++] = near;
+      continue;
+    }
+    for (size_t i = node.first; i < node.first + node.count; i++) {
+      const triangle_t& triangle = triangles_[i];
+      point_t p = cross(d, triangle.e2);
+      double determinant = dot(triangle.e1, p);
+      if (determinant == 0) continue;
+      point_t s = {
+          a[0] - triangle.p0[0], a[1] - triangle.p0[1], a[2] - triangle.p0[2]};
+      double inverse_determinant = 1 / determinant;
+      double u = dot(s, p) * inverse_determinant;
+      if (u < 0 || u > 1) continue;
+      point_t q = cross(s, triangle.e1);
+      double v = dot(d, q) * inverse_determinant;
+      if (v < 0 || u + v > 1) continue;
+      double fraction = dot(triangle.e2, q) * inverse_determinant;
+      if (fraction < 0 || fraction > fraction_max) continue;
+      fraction_max = fraction;
+      hit = hit_t {
+          .fraction = fraction,
+          .point =
+              {a[0] + fraction * d[0], a[1] + fraction * d[1],
+               a[2] + fraction * d[2]},
+          .triangle = triangle.index};
+    }
+  }
+  return hit;
+}
+
+inline std::vector<std::array<wall_mesh::point_t, 3>> wall_mesh::read_obj(
+    std::istream& is) {
+  std::vector<point_t> points;
+  std::vector<std::array<point_t, 3>> vertices;
+  for (std::string line; std::getline(is, line);) {
+    std::istringstream line_stream(line);
+    std::string tag;
+    line_stream >> tag;
+    if (tag == "v") {
+      point_t p;
+      line_stream >> p[0] >> p[1] >> p[2];
+      points.push_back(p);
+    } else if (tag == "f") {
+      std::vector<size_t> face;
+      for (std::string item; line_stream >> item;) {
+        long index = std::stol(item.substr(0, item.find('/')));
+        index = (index < 0 ? (long)points.size() + index : index - 1);
+        if (index < 0 || index >= (long)points.size())
+          throw std::runtime_error("invalid face in wall mesh: " + line);
+        face.push_back(index);
+      }
+      for (size_t i = 2; i < face.size(); i++)
+        vertices.push_back(
+            {points[face[0]], points[face[i - 1]], points[face[i]]});
+    }
+  }
+  return vertices;
+}
+
+inline std::vector<std::array<wall_mesh::point_t, 3>> wall_mesh::read_stl(
+    const std::string& filename) {
+  std::ifstream in_stream(filename, std::ios::binary);
+  if (!in_stream.is_open())
+    throw std::runtime_error("cannot read from file " + filename);
+  std::vector<std::array<point_t, 3>> vertices;
+  char header[80];
+  uint32_t n_triangles = 0;
+  in_stream.read(header, sizeof(header));
+  in_stream.read(reinterpret_cast<char*>(&n_triangles), sizeof(n_triangles));
+  if (in_stream &&
+      std::filesystem::file_size(filename) == 84 + 50 * (size_t)n_triangles) {
+    vertices.resize(n_triangles);
+    for (auto& triangle : vertices) {
+      float values[12];
+      char attributes[2];
+      in_stream.read(reinterpret_cast<char*>(values), sizeof(values));
+      in_stream.read(attributes, sizeof(attributes));
+      for (size_t i = 0; i < 3; i++)
+        for (size_t k = 0; k < 3; k++) triangle[i][k] = values[3 + 3 * i + k];
+    }
+    if (!in_stream)
+      throw std::runtime_error("cannot read from file " + filename);
+    return vertices;
+  }
+  in_stream.clear();
+  in_stream.seekg(0);
+  std::vector<point_t> points;
+  for (std::string word; in_stream >> word;)
+    if (word == "vertex") {
+      point_t p;
+      in_stream >> p[0] >> p[1] >> p[2];
+      points.push_back(p);
+      if (points.size() == 3) {
+        vertices.push_back({points[0], points[1], points[2]});
+        points.clear();
+      }
+    }
+  return vertices;
+}
+
+#endif  // GTRACE_WALL_MESH